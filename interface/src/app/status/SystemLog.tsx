@@ -117,11 +117,14 @@ const SystemLog = () => {
     interceptByGlobalResponded: false
   })
     .onMessage((message: { data: string }) => {
-      const rawData = message.data;
-      const logentry = JSON.parse(rawData) as LogEntry;
-      if (lastId < logentry.i) {
-        setLogEntries((log) => [...log, logentry]);
-        setLastId(logentry.i);
+      // an event carries an array of log entries
+      const rawData = JSON.parse(message.data) as LogEntry | LogEntry[];
+      const entries = (Array.isArray(rawData) ? rawData : [rawData]).filter(
+        (logentry) => lastId < logentry.i
+      );
+      if (entries.length) {
+        setLogEntries((log) => [...log, ...entries]);
+        setLastId(entries[entries.length - 1].i);
       }
     })
     .onError(() => {
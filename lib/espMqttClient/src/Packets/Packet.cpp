@@ -239,6 +239,46 @@ Packet::Packet(espMqttClientTypes::Error& error,
   error = espMqttClientTypes::Error::SUCCESS;
 }
 
+Packet::Packet(espMqttClientTypes::Error& error,
+               uint16_t packetId,
+               const char* topic,
+               size_t payloadLength,
+               const espMqttClientTypes::PayloadWriter& payloadWriter,
+               uint8_t qos,
+               bool retain)
+: _packetId(packetId)
+, _data(nullptr)
+, _size(0)
+, _payloadIndex(0)
+, _payloadStartIndex(0)
+, _payloadEndIndex(0)
+, _getPayload(nullptr) {
+  size_t remainingLength =
+    2 + strlen(topic) +  // topic length + topic
+    2 +                  // packet ID
+    payloadLength;
+
+  if (qos == 0) {
+    remainingLength -= 2;
+    _packetId = 0;
+  }
+
+  if (!_allocate(remainingLength, true)) {
+    error = espMqttClientTypes::Error::OUT_OF_MEMORY;
+    return;
+  }
+
+  size_t pos = _fillPublishHeader(packetId, topic, remainingLength, qos, retain);
+
+  // PAYLOAD, written directly into the packet buffer
+  if (payloadWriter(&_data[pos], payloadLength) != payloadLength) {
+    error = espMqttClientTypes::Error::MALFORMED_PARAMETER;
+    return;
+  }
+
+  error = espMqttClientTypes::Error::SUCCESS;
+}
+
 Packet::Packet(espMqttClientTypes::Error& error, uint16_t packetId, const char* topic, uint8_t qos)
 : _packetId(packetId)
 , _data(nullptr)
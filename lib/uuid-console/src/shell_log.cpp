@@ -41,20 +41,12 @@ const uuid::log::Logger & Shell::logger() {
     return logger_instance;
 }
 
-Shell::QueuedLogMessage::QueuedLogMessage(unsigned long id, std::shared_ptr<uuid::log::Message> && content)
-    : id_(id)
-    , content_(std::move(content)) {
-}
-
-void Shell::operator<<(std::shared_ptr<uuid::log::Message> message) {
+void Shell::operator<<(const uuid::log::Message & message) {
 #if UUID_CONSOLE_THREAD_SAFE
     std::lock_guard<std::mutex> lock{mutex_};
 #endif
-    if (log_messages_.size() >= maximum_log_messages_) {
-        log_messages_.pop_front();
-    }
 
-    log_messages_.emplace_back(log_message_id_++, std::move(message));
+    log_messages_.push({log_message_id_++, message.id});
 }
 
 uuid::log::Level Shell::log_level() const {
@@ -70,7 +62,7 @@ size_t Shell::maximum_log_messages() const {
     std::lock_guard<std::mutex> lock{mutex_};
 #endif
 
-    return maximum_log_messages_;
+    return log_messages_.capacity();
 }
 
 void Shell::maximum_log_messages(size_t count) {
@@ -78,10 +70,7 @@ void Shell::maximum_log_messages(size_t count) {
     std::lock_guard<std::mutex> lock{mutex_};
 #endif
 
-    maximum_log_messages_ = std::max((size_t)1, count);
-    while (log_messages_.size() > maximum_log_messages_) {
-        log_messages_.pop_front();
-    }
+    log_messages_.capacity(count);
 }
 
 void Shell::output_logs() {
@@ -92,10 +81,10 @@ void Shell::output_logs() {
     if (log_messages_.empty())
         return;
 
-    size_t count   = std::max((size_t)1, MAX_LOG_MESSAGES);
-    auto   message = log_messages_.front();
+    size_t count  = std::max((size_t)1, MAX_LOG_MESSAGES);
+    auto   queued = log_messages_.front();
 
-    log_messages_.pop_front();
+    log_messages_.pop();
 #if UUID_CONSOLE_THREAD_SAFE
     lock.unlock();
 #endif
@@ -105,36 +94,42 @@ void Shell::output_logs() {
         prompt_displayed_ = false;
     }
 
+    uuid::log::Message message;
+    char               text[uuid::log::Logger::MAX_LOG_LENGTH + 1];
+
     while (1) {
-        time_t offset = time(nullptr) - uuid::get_uptime_sec();
-        if (offset < 1500000000L) {
-            print(uuid::log::format_timestamp_ms(message.content_->uptime_ms, 3));
-        } else {
-            time_t t1 = offset + (time_t)(message.content_->uptime_ms / 1000);
-            char   timestr[25];
-            strftime(timestr, 25, "%FT%T", localtime(&t1));
-            printf("%s.%03d", timestr, (uint16_t)(message.content_->uptime_ms % 1000));
-        }
-        printf(" %c %lu: [%s] ", uuid::log::format_level_char(message.content_->level), message.id_, message.content_->name);
-
-        if ((message.content_->level == uuid::log::Level::ERR) || (message.content_->level == uuid::log::Level::WARNING)) {
-            print(COLOR_RED);
-            println(message.content_->text);
-            print(COLOR_RESET);
-        } else if (message.content_->level == uuid::log::Level::INFO) {
-            print(COLOR_YELLOW);
-            println(message.content_->text);
-            print(COLOR_RESET);
-        } else if (message.content_->level == uuid::log::Level::DEBUG) {
-            print(COLOR_CYAN);
-            println(message.content_->text);
-            print(COLOR_RESET);
-        } else {
-            println(message.content_->text);
+        // skip messages that have been overwritten in the arena
+        if (uuid::log::Logger::read_message(queued.message_id_, message, text, sizeof(text))) {
+            time_t offset = time(nullptr) - uuid::get_uptime_sec();
+            if (offset < 1500000000L) {
+                print(uuid::log::format_timestamp_ms(message.uptime_ms, 3));
+            } else {
+                time_t t1 = offset + (time_t)(message.uptime_ms / 1000);
+                char   timestr[25];
+                strftime(timestr, 25, "%FT%T", localtime(&t1));
+                printf("%s.%03d", timestr, (uint16_t)(message.uptime_ms % 1000));
+            }
+            printf(" %c %lu: [%s] ", uuid::log::format_level_char(message.level), queued.id_, message.name);
+
+            if ((message.level == uuid::log::Level::ERR) || (message.level == uuid::log::Level::WARNING)) {
+                print(COLOR_RED);
+                println(message.text);
+                print(COLOR_RESET);
+            } else if (message.level == uuid::log::Level::INFO) {
+                print(COLOR_YELLOW);
+                println(message.text);
+                print(COLOR_RESET);
+            } else if (message.level == uuid::log::Level::DEBUG) {
+                print(COLOR_CYAN);
+                println(message.text);
+                print(COLOR_RESET);
+            } else {
+                println(message.text);
+            }
+
+            ::yield();
         }
 
-        ::yield();
-
         count--;
         if (count == 0) {
             break;
@@ -150,8 +145,8 @@ void Shell::output_logs() {
             break;
         }
 
-        message = log_messages_.front();
-        log_messages_.pop_front();
+        queued = log_messages_.front();
+        log_messages_.pop();
 #if UUID_CONSOLE_THREAD_SAFE
         lock.unlock();
 #endif
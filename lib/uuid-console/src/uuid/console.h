@@ -938,7 +938,7 @@ class Shell : public std::enable_shared_from_this<Shell>, public uuid::log::Hand
 	 * @param[in] message New log message, shared by all handlers.
 	 * @since 0.1.0
 	 */
-    virtual void operator<<(std::shared_ptr<uuid::log::Message> message) override;
+    virtual void operator<<(const uuid::log::Message & message) override;
     /**
 	 * Get the current log level.
 	 *
@@ -1513,20 +1513,9 @@ class Shell : public std::enable_shared_from_this<Shell>, public uuid::log::Hand
 	 *
 	 * @since 0.1.0
 	 */
-    class QueuedLogMessage {
-      public:
-        /**
-		 * Create a queued log message.
-		 *
-		 * @param[in] id Identifier to use for the log message on the queue.
-		 * @param[in] content Log message content.
-		 * @since 0.1.0
-		 */
-        QueuedLogMessage(unsigned long id, std::shared_ptr<uuid::log::Message> && content);
-        ~QueuedLogMessage() = default;
-
-        unsigned long                             id_;      /*!< Sequential identifier for this log message. @since 0.1.0 */
-        std::shared_ptr<const uuid::log::Message> content_; /*!< Log message content. @since 0.1.0 */
+    struct QueuedLogMessage {
+        unsigned long id_;         /*!< Sequential identifier for this log message. @since 0.1.0 */
+        unsigned long message_id_; /*!< Identifier of the message in the log arena. @since 3.1.0 */
     };
 
     Shell(const Shell &)             = delete;
@@ -1652,9 +1641,8 @@ class Shell : public std::enable_shared_from_this<Shell>, public uuid::log::Hand
 #if UUID_CONSOLE_THREAD_SAFE
     mutable std::mutex mutex_; /*!< Mutex for queued log messages. @since 1.0.0 */
 #endif
-    unsigned long               log_message_id_ = 0;                      /*!< The next identifier to use for queued log messages. @since 0.1.0 */
-    std::list<QueuedLogMessage> log_messages_;                            /*!< Queued log messages, in the order they were received. @since 0.1.0 */
-    size_t                      maximum_log_messages_ = MAX_LOG_MESSAGES; /*!< Maximum command line length in bytes. @since 0.6.0 */
+    unsigned long                             log_message_id_ = 0;            /*!< The next identifier to use for queued log messages. @since 0.1.0 */
+    uuid::log::MessageQueue<QueuedLogMessage> log_messages_{MAX_LOG_MESSAGES}; /*!< Queued log messages, in the order they were received. @since 0.1.0 */
     std::string                 line_buffer_; /*!< Command line buffer. Limited to maximum_command_line_length() bytes. @since 0.1.0 */
     size_t                      maximum_command_line_length_ = MAX_COMMAND_LINE_LENGTH; /*!< Maximum command line length in bytes. @since 0.6.0 */
     unsigned char               previous_  = 0; /*!< Previous character that was entered on the command line. Used to detect CRLF line endings. @since 0.1.0 */
@@ -0,0 +1,189 @@
+/*
+ * uuid-log - Microcontroller logging framework
+ * Copyright 2019,2021-2022  Simon Arlott
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <uuid/log.h>
+
+#include <Arduino.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#if UUID_LOG_THREAD_SAFE
+#include <mutex>
+#endif
+#include <vector>
+
+namespace uuid {
+
+namespace log {
+
+//! @cond false
+// messages are stored as a record followed by the text, wrapping around
+// the end of the buffer, the offset of each record is kept by id
+struct Record {
+    uint64_t     uptime_ms;
+    const char * name;
+    uint16_t     length;
+    Level        level;
+    Facility     facility;
+};
+
+// average text length used to size the record offsets
+static constexpr size_t MIN_TEXT_LENGTH = 16;
+
+struct Arena {
+    std::vector<char>     data;
+    std::vector<uint32_t> offsets;
+    size_t                head     = 0; // offset of the oldest record
+    size_t                used     = 0;
+    unsigned long         first_id = 0; // oldest record
+    unsigned long         next_id  = 0;
+    unsigned long         lost     = 0;
+
+    Arena() {
+        resize(Logger::DEFAULT_ARENA_SIZE);
+    }
+
+    void resize(size_t size) {
+        size = std::max(size, sizeof(Record) + Logger::MAX_LOG_LENGTH);
+        std::vector<char>(size).swap(data);
+        std::vector<uint32_t>(size / (sizeof(Record) + MIN_TEXT_LENGTH)).swap(offsets);
+        head     = 0;
+        used     = 0;
+        first_id = next_id;
+    }
+
+    void write(size_t pos, const void * src, size_t len) {
+        pos %= data.size();
+        size_t first = std::min(len, data.size() - pos);
+        memcpy(&data[pos], src, first);
+        memcpy(&data[0], (const char *)src + first, len - first);
+    }
+
+    void read(size_t pos, void * dst, size_t len) const {
+        pos %= data.size();
+        size_t first = std::min(len, data.size() - pos);
+        memcpy(dst, &data[pos], first);
+        memcpy((char *)dst + first, &data[0], len - first);
+    }
+
+    void drop() {
+        Record record;
+        read(head, &record, sizeof(record));
+        size_t size = sizeof(record) + record.length;
+        head        = (head + size) % data.size();
+        used -= size;
+        first_id++;
+    }
+};
+
+static Arena & arena() {
+    static Arena arena;
+
+    return arena;
+}
+//! @endcond
+
+size_t Logger::arena_size() {
+#if UUID_LOG_THREAD_SAFE
+    std::lock_guard<std::mutex> lock{mutex_};
+#endif
+
+    return arena().data.size();
+}
+
+void Logger::arena_size(size_t size) {
+#if UUID_LOG_THREAD_SAFE
+    std::lock_guard<std::mutex> lock{mutex_};
+#endif
+
+    arena().resize(size);
+}
+
+unsigned long Logger::arena_lost() {
+#if UUID_LOG_THREAD_SAFE
+    std::lock_guard<std::mutex> lock{mutex_};
+#endif
+
+    return arena().lost;
+}
+
+/* Mutex already locked by caller. */
+unsigned long Logger::store(uint64_t uptime_ms, Level level, Facility facility, const char * name, const char * text, size_t length) {
+    Arena & a = arena();
+
+    Record record;
+    record.uptime_ms = uptime_ms;
+    record.name      = name;
+    record.length    = std::min(length, MAX_LOG_LENGTH);
+    record.level     = level;
+    record.facility  = facility;
+
+    size_t size = sizeof(record) + record.length;
+    while (a.first_id != a.next_id && (a.used + size > a.data.size() || a.next_id - a.first_id >= a.offsets.size())) {
+        a.drop();
+    }
+
+    size_t pos                              = (a.head + a.used) % a.data.size();
+    a.offsets[a.next_id % a.offsets.size()] = pos;
+    a.write(pos, &record, sizeof(record));
+    a.write(pos + sizeof(record), text, record.length);
+    a.used += size;
+
+    return a.next_id++;
+}
+
+unsigned long Logger::store_message(Level level, Facility facility, const char * name, const char * text) {
+    uint64_t uptime_ms = get_uptime_ms();
+
+#if UUID_LOG_THREAD_SAFE
+    std::lock_guard<std::mutex> lock{mutex_};
+#endif
+
+    return store(uptime_ms, level, facility, name, text, strlen(text));
+}
+
+bool Logger::read_message(unsigned long id, Message & message, char * text, size_t size) {
+#if UUID_LOG_THREAD_SAFE
+    std::lock_guard<std::mutex> lock{mutex_};
+#endif
+
+    Arena & a = arena();
+
+    if (id - a.first_id >= a.next_id - a.first_id) {
+        if (id < a.first_id) {
+            a.lost++;
+        }
+        return false;
+    }
+
+    size_t pos = a.offsets[id % a.offsets.size()];
+    Record record;
+    a.read(pos, &record, sizeof(record));
+
+    size_t length = std::min((size_t)record.length, size - 1);
+    a.read(pos + sizeof(record), text, length);
+    text[length] = '\0';
+
+    message = Message{id, record.uptime_ms, record.level, record.facility, record.name, text};
+    return true;
+}
+
+} // namespace log
+
+} // namespace uuid
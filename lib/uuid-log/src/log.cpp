@@ -53,12 +53,13 @@ static Level constrain_level(Level level) {
 }
 //! @endcond
 
-Message::Message(uint64_t uptime_ms, Level level, Facility facility, const char * name, const std::string && text)
-    : uptime_ms(uptime_ms)
+Message::Message(unsigned long id, uint64_t uptime_ms, Level level, Facility facility, const char * name, const char * text)
+    : id(id)
+    , uptime_ms(uptime_ms)
     , level(level)
     , facility(facility)
     , name(name)
-    , text(std::move(text)) {
+    , text(text) {
 }
 
 Logger::Logger(const char * name, Facility facility)
@@ -232,23 +233,25 @@ void Logger::vlog(Level level, const char * format, va_list ap) const {
 }
 
 void Logger::vlog(Level level, Facility facility, const char * format, va_list ap) const {
-    std::vector<char> text(MAX_LOG_LENGTH + 1);
+    char text[MAX_LOG_LENGTH + 1];
 
-    if (vsnprintf(text.data(), text.size(), format, ap) <= 0) {
+    int length = vsnprintf(text, sizeof(text), format, ap);
+    if (length <= 0) {
         return;
     }
 
-    dispatch(level, facility, text);
+    dispatch(level, facility, text, std::min((size_t)length, MAX_LOG_LENGTH));
 }
 
-void Logger::dispatch(Level level, Facility facility, std::vector<char> & text) const {
-    std::shared_ptr<Message> message = std::make_shared<Message>(get_uptime_ms(), level, facility, name_, text.data());
-    text.resize(0);
+void Logger::dispatch(Level level, Facility facility, const char * text, size_t length) const {
+    uint64_t uptime_ms = get_uptime_ms();
 
 #if UUID_LOG_THREAD_SAFE
     std::lock_guard<std::mutex> lock{mutex_};
 #endif
 
+    Message message{store(uptime_ms, level, facility, name_, text, length), uptime_ms, level, facility, name_, text};
+
     for (auto & handler : *registered_handlers()) {
         if (level <= handler.second) {
             *handler.first << message;
@@ -38,7 +38,7 @@ size_t PrintHandler::maximum_log_messages() const {
     std::lock_guard<std::mutex> lock{mutex_};
 #endif
 
-    return maximum_log_messages_;
+    return log_messages_.capacity();
 }
 
 void PrintHandler::maximum_log_messages(size_t count) {
@@ -46,11 +46,7 @@ void PrintHandler::maximum_log_messages(size_t count) {
     std::lock_guard<std::mutex> lock{mutex_};
 #endif
 
-    maximum_log_messages_ = std::max((size_t)1, count);
-
-    while (log_messages_.size() > maximum_log_messages_) {
-        log_messages_.pop_front();
-    }
+    log_messages_.capacity(count);
 }
 
 void PrintHandler::loop(size_t count) {
@@ -61,20 +57,24 @@ void PrintHandler::loop(size_t count) {
     count = std::max((size_t)1, count);
 
     while (!log_messages_.empty()) {
-        auto message = log_messages_.front();
+        auto id = log_messages_.front();
 
-        log_messages_.pop_front();
+        log_messages_.pop();
 #if UUID_LOG_THREAD_SAFE
         lock.unlock();
 #endif
 
-        print_.print(uuid::log::format_timestamp_ms(message->uptime_ms, 3).c_str());
-        print_.print(' ');
-        print_.print(uuid::log::format_level_char(message->level));
-        print_.print(" [");
-        print_.print(message->name);
-        print_.print("] ");
-        print_.println(message->text.c_str());
+        Message message;
+        char    text[Logger::MAX_LOG_LENGTH + 1];
+        if (Logger::read_message(id, message, text, sizeof(text))) {
+            print_.print(uuid::log::format_timestamp_ms(message.uptime_ms, 3).c_str());
+            print_.print(' ');
+            print_.print(uuid::log::format_level_char(message.level));
+            print_.print(" [");
+            print_.print(message.name);
+            print_.print("] ");
+            print_.println(message.text);
+        }
 
         count--;
         if (count == 0) {
@@ -89,16 +89,12 @@ void PrintHandler::loop(size_t count) {
     }
 }
 
-void PrintHandler::operator<<(std::shared_ptr<Message> message) {
+void PrintHandler::operator<<(const Message & message) {
 #if UUID_LOG_THREAD_SAFE
     std::lock_guard<std::mutex> lock{mutex_};
 #endif
 
-    if (log_messages_.size() >= maximum_log_messages_) {
-        log_messages_.pop_front();
-    }
-
-    log_messages_.emplace_back(std::move(message));
+    log_messages_.push(message.id);
 }
 
 } // namespace log
@@ -51,6 +51,10 @@
 #include <mutex>
 #endif
 
+#ifndef UUID_LOG_ARENA_SIZE
+#define UUID_LOG_ARENA_SIZE 8192
+#endif
+
 namespace uuid {
 
 /**
@@ -246,8 +250,10 @@ bool parse_level_lowercase(const std::string & name, Level & level);
 /**
  * Log message text with timestamp and logger attributes.
  *
- * These will be created when a message is logged and then passed to
- * all registered handlers.
+ * Messages are written once to the message arena when they are logged
+ * and then passed to all registered handlers. Handlers that output
+ * messages later keep the id and read the message back with
+ * Logger::read_message().
  *
  * @since 1.0.0
  */
@@ -255,6 +261,7 @@ struct Message {
     /**
 	 * Create a new log message (not directly useful).
 	 *
+	 * @param[in] id Identifier of the message in the arena.
 	 * @param[in] uptime_ms System uptime, see uuid::get_uptime_ms().
 	 * @param[in] level Severity level of the message.
 	 * @param[in] facility Facility type of the process logging the message.
@@ -262,37 +269,46 @@ struct Message {
 	 * @param[in] text Log message text.
 	 * @since 1.0.0
 	 */
-    Message(uint64_t uptime_ms, Level level, Facility facility, const char * name, const std::string && text);
+    Message(unsigned long id, uint64_t uptime_ms, Level level, Facility facility, const char * name, const char * text);
+    Message()  = default;
     ~Message() = default;
 
+    /**
+	 * Identifier of the message in the arena, increments for every
+	 * message.
+	 *
+	 * @since 3.1.0
+	 */
+    unsigned long id = 0;
+
     /**
 	 * System uptime at the time the message was logged.
 	 *
 	 * @see uuid::get_uptime_ms()
 	 * @since 1.0.0
 	 */
-    const uint64_t uptime_ms;
+    uint64_t uptime_ms = 0;
 
     /**
 	 * Severity level of the message.
 	 *
 	 * @since 1.0.0
 	 */
-    const Level level;
+    Level level = Level::OFF;
 
     /**
 	 * Facility type of the process that logged the message.
 	 *
 	 * @since 1.0.0
 	 */
-    const Facility facility;
+    Facility facility = Facility::KERN;
 
     /**
 	 * Name of the logger used
 	 *
 	 * @since 1.0.0
 	 */
-    const char * name;
+    const char * name = nullptr;
 
     /**
 	 * Formatted log message text.
@@ -300,9 +316,115 @@ struct Message {
 	 * Does not include any of the other message attributes, those must
 	 * be added by the handler when outputting messages.
 	 *
+	 * Only valid while the handler is called, or in the buffer given to
+	 * Logger::read_message().
+	 *
 	 * @since 1.0.0
 	 */
-    const std::string text;
+    const char * text = nullptr;
+};
+
+/**
+ * Fixed size queue for handlers that output messages later.
+ *
+ * Handlers keep small entries (at least the message id) instead of the
+ * messages. The storage is allocated when the capacity is set and a
+ * full queue discards its oldest entry.
+ *
+ * @since 3.1.0
+ */
+template <typename T>
+class MessageQueue {
+  public:
+    explicit MessageQueue(size_t size) {
+        capacity(size);
+    }
+
+    inline size_t capacity() const {
+        return entries_.size();
+    }
+
+    /**
+	 * Set the capacity, keeping the newest entries.
+	 *
+	 * @param[in] capacity Maximum number of entries, at least one.
+	 * @since 3.1.0
+	 */
+    void capacity(size_t size) {
+        std::vector<T> entries(std::max((size_t)1, size));
+        size_t         count = std::min(count_, entries.size());
+        for (size_t i = 0; i < count; i++) {
+            entries[i] = (*this)[count_ - count + i];
+        }
+        entries_.swap(entries);
+        head_  = 0;
+        count_ = count;
+    }
+
+    inline size_t size() const {
+        return count_;
+    }
+
+    inline bool empty() const {
+        return count_ == 0;
+    }
+
+    inline T & front() {
+        return entries_[head_];
+    }
+
+    inline const T & operator[](size_t index) const {
+        return entries_[(head_ + index) % entries_.size()];
+    }
+
+    /**
+	 * Add an entry at the end.
+	 *
+	 * @return False if the oldest entry was discarded to make room.
+	 * @since 3.1.0
+	 */
+    bool push(const T & entry) {
+        bool room = count_ < entries_.size();
+        if (!room) {
+            pop();
+        }
+        entries_[(head_ + count_++) % entries_.size()] = entry;
+        return room;
+    }
+
+    void pop() {
+        head_ = (head_ + 1) % entries_.size();
+        count_--;
+    }
+
+    void clear() {
+        head_  = 0;
+        count_ = 0;
+    }
+
+    /**
+	 * Remove all entries matching a predicate, keeping the order.
+	 *
+	 * The predicate may modify the entries that are kept.
+	 *
+	 * @since 3.1.0
+	 */
+    template <typename Predicate>
+    void remove_if(Predicate predicate) {
+        size_t count = 0;
+        for (size_t i = 0; i < count_; i++) {
+            T entry = (*this)[i];
+            if (!predicate(entry)) {
+                entries_[(head_ + count++) % entries_.size()] = entry;
+            }
+        }
+        count_ = count;
+    }
+
+  private:
+    std::vector<T> entries_;
+    size_t         head_  = 0;
+    size_t         count_ = 0;
 };
 
 class Logger;
@@ -335,12 +457,15 @@ class Handler {
 	 * messages while processing those messages. Release the lock while
 	 * performing the processing.
 	 *
+	 * The message text is only valid during this call, queue the
+	 * message id and use Logger::read_message() to process it later.
 	 * Queues should have a maximum size and discard the oldest message
-	 * when full.
+	 * when full, see MessageQueue.
 	 *
 	 * It is not safe for the handler to directly or indirectly do any
 	 * of the following while this function is being called:
 	 * - Log a message.
+	 * - Read a message.
 	 * - Read the log level of any handler.
 	 * - Modify the log level of any handler.
 	 * - Unregister any handler.
@@ -348,7 +473,7 @@ class Handler {
 	 * @param[in] message New log message, shared by all handlers.
 	 * @since 1.0.0
 	 */
-    virtual void operator<<(std::shared_ptr<Message> message) = 0;
+    virtual void operator<<(const Message & message) = 0;
 
   protected:
     Handler() = default;
@@ -382,6 +507,13 @@ class Logger {
 	 */
     static constexpr size_t MAX_LOG_LENGTH = 255;
 
+    /**
+	 * Default size of the message arena in bytes.
+	 *
+	 * @since 3.1.0
+	 */
+    static constexpr size_t DEFAULT_ARENA_SIZE = UUID_LOG_ARENA_SIZE;
+
     /**
 	 * Create a new logger with the given name and logging facility.
 	 *
@@ -439,6 +571,64 @@ class Logger {
         return global_level_;
     };
 
+    /**
+	 * Get the size of the message arena.
+	 *
+	 * @return Size of the arena in bytes.
+	 * @since 3.1.0
+	 */
+    static size_t arena_size();
+
+    /**
+	 * Set the size of the message arena.
+	 *
+	 * All messages are stored once in this fixed size ring, the oldest
+	 * messages are overwritten when it is full. Messages in the arena
+	 * are discarded when the size changes, so set it at startup.
+	 *
+	 * @param[in] size Size of the arena in bytes.
+	 * @since 3.1.0
+	 */
+    static void arena_size(size_t size);
+
+    /**
+	 * Get the number of messages that have been overwritten before
+	 * all handlers read them.
+	 *
+	 * @return Number of messages that could not be read back.
+	 * @since 3.1.0
+	 */
+    static unsigned long arena_lost();
+
+    /**
+	 * Read a message back from the arena.
+	 *
+	 * Not to be called from Handler::operator<<().
+	 *
+	 * @param[in] id Identifier of the message.
+	 * @param[out] message The message, its text points to the buffer.
+	 * @param[out] text Buffer for the text, MAX_LOG_LENGTH + 1 bytes
+	 *                  are enough for any message.
+	 * @param[in] size Size of the text buffer.
+	 * @return False if the message has been overwritten.
+	 * @since 3.1.0
+	 */
+    static bool read_message(unsigned long id, Message & message, char * text, size_t size);
+
+    /**
+	 * Store a message in the arena without passing it to the handlers.
+	 *
+	 * For handlers that generate their own messages.
+	 *
+	 * @param[in] level Severity level of the message.
+	 * @param[in] facility Facility type of the message.
+	 * @param[in] name Logger name, must remain valid.
+	 * @param[in] text Log message text.
+	 * @return Identifier of the message.
+	 * @since 3.1.0
+	 */
+    static unsigned long store_message(Level level, Facility facility, const char * name, const char * text);
+
     /**
 	 * Determine if the specified log level is enabled by the effective
 	 * log level.
@@ -643,9 +833,20 @@ class Logger {
 	 * @param[in] level Severity level of the message.
 	 * @param[in] facility Facility type of the process logging the message.
 	 * @param[in] text Log message text.
+	 * @param[in] length Length of the text.
 	 * @since 1.0.0
 	 */
-    void dispatch(Level level, Facility facility, std::vector<char> & text) const;
+    void dispatch(Level level, Facility facility, const char * text, size_t length) const;
+
+    /**
+	 * Write a message to the arena, overwriting the oldest messages.
+	 *
+	 * Mutex already locked by caller.
+	 *
+	 * @return Identifier of the message.
+	 * @since 3.1.0
+	 */
+    static unsigned long store(uint64_t uptime_ms, Level level, Facility facility, const char * name, const char * text, size_t length);
 
     static std::atomic<Level> global_level_; /*!< Minimum global log level across all handlers. @since 3.0.0 */
 #if UUID_LOG_THREAD_SAFE
@@ -715,15 +916,14 @@ class PrintHandler : public uuid::log::Handler {
 	 * @param[in] message New log message, shared by all handlers.
 	 * @since 2.2.0
 	 */
-    virtual void operator<<(std::shared_ptr<Message> message);
+    virtual void operator<<(const Message & message);
 
   private:
     Print & print_; /*!< Destination for output of log messages. @since 2.2.0 */
 #if UUID_LOG_THREAD_SAFE
     mutable std::mutex mutex_; /*!< Mutex for configuration, state and queued log messages. @since 2.3.0 */
 #endif
-    size_t maximum_log_messages_ = MAX_LOG_MESSAGES;   /*!< Maximum number of log messages to buffer before they are output. @since 2.2.0 */
-    std::list<std::shared_ptr<Message>> log_messages_; /*!< Queued log messages, in the order they were received. @since 2.2.0 */
+    MessageQueue<unsigned long> log_messages_{MAX_LOG_MESSAGES}; /*!< Ids of queued log messages, in the order they were received. @since 2.2.0 */
 };
 
 } // namespace log
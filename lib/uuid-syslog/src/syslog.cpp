@@ -111,15 +111,14 @@ void SyslogService::remove_queued_messages(uuid::log::Level level) {
 #endif
     unsigned long offset = 0;
 
-    for (auto it = log_messages_.begin(); it != log_messages_.end();) {
-        if (it->content_->level > level) {
+    log_messages_.remove_if([&](QueuedLogMessage & message) {
+        if (message.level_ > level) {
             offset++;
-            it = log_messages_.erase(it);
-        } else {
-            it->id_ -= offset;
-            it++;
+            return true;
         }
-    }
+        message.id_ -= offset;
+        return false;
+    });
 
     log_message_id_ -= offset;
 }
@@ -148,18 +147,14 @@ size_t SyslogService::maximum_log_messages() const {
 #if UUID_SYSLOG_THREAD_SAFE
     std::lock_guard<std::mutex> lock{mutex_};
 #endif
-    return maximum_log_messages_;
+    return log_messages_.capacity();
 }
 
 void SyslogService::maximum_log_messages(size_t count) {
 #if UUID_SYSLOG_THREAD_SAFE
     std::lock_guard<std::mutex> lock{mutex_};
 #endif
-    maximum_log_messages_ = std::max((size_t)1, count);
-
-    while (log_messages_.size() > maximum_log_messages_) {
-        log_messages_.pop_front();
-    }
+    log_messages_.capacity(count);
 }
 
 size_t SyslogService::current_log_messages() const {
@@ -226,9 +221,10 @@ void SyslogService::mark_interval(unsigned long interval) {
     mark_interval_ = (uint64_t)interval * 1000;
 }
 
-SyslogService::QueuedLogMessage::QueuedLogMessage(unsigned long id, std::shared_ptr<uuid::log::Message> && content)
+SyslogService::QueuedLogMessage::QueuedLogMessage(unsigned long id, const uuid::log::Message & message)
     : id_(id)
-    , content_(std::move(content)) {
+    , message_id_(message.id)
+    , level_(message.level) {
     // Added for EMS-ESP
     // if (time_good_ || emsesp::EMSESP::system_.network_connected()) {
     if (time_good_) {
@@ -253,16 +249,13 @@ SyslogService::QueuedLogMessage::QueuedLogMessage(unsigned long id, std::shared_
 }
 
 /* Mutex already locked by caller. */
-void SyslogService::add_message(std::shared_ptr<uuid::log::Message> & message) {
-    if (log_messages_.size() >= maximum_log_messages_) {
-        log_messages_.pop_front();
+void SyslogService::add_message(const uuid::log::Message & message) {
+    if (!log_messages_.push(QueuedLogMessage{log_message_id_++, message})) {
         log_message_fails_++;
     }
-
-    log_messages_.emplace_back(log_message_id_++, std::move(message));
 }
 
-void SyslogService::operator<<(std::shared_ptr<uuid::log::Message> message) {
+void SyslogService::operator<<(const uuid::log::Message & message) {
 #if UUID_SYSLOG_THREAD_SAFE
     std::lock_guard<std::mutex> lock{mutex_};
 #endif
@@ -306,8 +299,8 @@ void SyslogService::loop() {
 #endif
 
             last_message_ = last_transmit_;
-            if (!log_messages_.empty() && log_messages_.front().content_ == message.content_) {
-                log_messages_.pop_front();
+            if (!log_messages_.empty() && log_messages_.front().id_ == message.id_) {
+                log_messages_.pop();
             }
 
 #if UUID_SYSLOG_THREAD_SAFE
@@ -335,12 +328,15 @@ void SyslogService::loop() {
         if (uuid::get_uptime_ms() - last_message_ >= mark_interval_) {
             // This is generated manually because the log level may not
             // be high enough to receive INFO messages.
-            auto message = std::make_shared<uuid::log::Message>(uuid::get_uptime_ms(),
-                                                                uuid::log::Level::INFO,
-                                                                uuid::log::Facility::SYSLOG,
-                                                                (__pstr__logger_name),
-                                                                "-- MARK --");
-            add_message(message);
+            const char * text = "-- MARK --";
+#if UUID_SYSLOG_THREAD_SAFE
+            lock.unlock(); // the arena is locked by the logger
+#endif
+            unsigned long id = uuid::log::Logger::store_message(uuid::log::Level::INFO, uuid::log::Facility::SYSLOG, __pstr__logger_name, text);
+#if UUID_SYSLOG_THREAD_SAFE
+            lock.lock();
+#endif
+            add_message(uuid::log::Message{id, uuid::get_uptime_ms(), uuid::log::Level::INFO, uuid::log::Facility::SYSLOG, __pstr__logger_name, text});
         }
     }
 }
@@ -470,6 +466,12 @@ bool SyslogService::can_transmit() {
 }
 
 bool SyslogService::transmit(const QueuedLogMessage & message) {
+    uuid::log::Message content;
+    char               text[uuid::log::Logger::MAX_LOG_LENGTH + 1];
+    if (!uuid::log::Logger::read_message(message.message_id_, content, text, sizeof(text))) {
+        return true; // overwritten in the log arena, nothing to send
+    }
+
     struct tm tm;
 
     // Changes for EMS-ESP
@@ -510,7 +512,7 @@ bool SyslogService::transmit(const QueuedLogMessage & message) {
 	 * The maximum possible priority value does not exceed the requirement that
 	 * the PRI part MUST be 3-5 characters.
 	 */
-    udp_.printf("<%u>1 ", (uint8_t)(message.content_->facility * 8U) + std::min(7U, (unsigned int)message.content_->level));
+    udp_.printf("<%u>1 ", (uint8_t)(content.facility * 8U) + std::min(7U, (unsigned int)content.level));
 
     if (tm.tm_year != 0) {
         // udp_.printf_P("%04u-%02u-%02uT%02u:%02u:%02u.%06luZ",
@@ -537,12 +539,12 @@ bool SyslogService::transmit(const QueuedLogMessage & message) {
         udp_.print('-');
     }
 
-    udp_.printf(" %s %s - - - ", hostname_.c_str(), message.content_->name);
+    udp_.printf(" %s %s - - - ", hostname_.c_str(), content.name);
 
     char id_c_str[15];
     snprintf(id_c_str, sizeof(id_c_str), " %lu: ", message.id_);
-    std::string msgstr = uuid::log::format_timestamp_ms(message.content_->uptime_ms, 3) + ' ' + uuid::log::format_level_char(message.content_->level) + id_c_str
-                         + message.content_->text;
+    std::string msgstr = uuid::log::format_timestamp_ms(content.uptime_ms, 3) + ' ' + uuid::log::format_level_char(content.level) + id_c_str
+                         + content.text;
     for (uint16_t i = 0; i < msgstr.length(); i++) {
         if (msgstr.at(i) & 0x80) {
             udp_.print("\xEF\xBB\xBF");
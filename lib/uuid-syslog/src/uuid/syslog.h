@@ -215,7 +215,7 @@ class SyslogService : public uuid::log::Handler {
 	 * @param[in] message New log message, shared by all handlers.
 	 * @since 1.0.0
 	 */
-    virtual void operator<<(std::shared_ptr<uuid::log::Message> message);
+    virtual void operator<<(const uuid::log::Message & message);
 
     /**
 	* added for EMS-ESP
@@ -254,15 +254,17 @@ class SyslogService : public uuid::log::Handler {
 		 * Create a queued log message.
 		 *
 		 * @param[in] id Identifier to use for the log message on the queue.
-		 * @param[in] content Log message content.
+		 * @param[in] message Log message, the content stays in the log arena.
 		 * @since 1.0.0
 		 */
-        QueuedLogMessage(unsigned long id, std::shared_ptr<uuid::log::Message> && content);
+        QueuedLogMessage(unsigned long id, const uuid::log::Message & message);
+        QueuedLogMessage()  = default;
         ~QueuedLogMessage() = default;
 
-        unsigned long                             id_;      /*!< Sequential identifier for this log message. @since 1.0.0 */
-        struct timeval                            time_;    /*!< Time message was received. @since 1.0.0 */
-        std::shared_ptr<const uuid::log::Message> content_; /*!< Log message content. @since 1.0.0 */
+        unsigned long    id_         = 0;                   /*!< Sequential identifier for this log message. @since 1.0.0 */
+        unsigned long    message_id_ = 0;                   /*!< Identifier of the message in the log arena. @since 3.1.0 */
+        struct timeval   time_;                             /*!< Time message was received. @since 1.0.0 */
+        uuid::log::Level level_ = uuid::log::Level::OFF;    /*!< Severity level of the message. @since 3.1.0 */
 
       private:
         static bool time_good_; /*!< System time appears to be valid. @since 1.0.0 */
@@ -279,7 +281,7 @@ class SyslogService : public uuid::log::Handler {
 	 * @param[in] message New log message, shared by all handlers.
 	 * @since 2.2.0
 	 */
-    void add_message(std::shared_ptr<uuid::log::Message> & message);
+    void add_message(const uuid::log::Message & message);
 
     /**
 	 * Remove messages that were queued before the log level was set.
@@ -319,11 +321,10 @@ class SyslogService : public uuid::log::Handler {
 #if UUID_SYSLOG_THREAD_SAFE
     mutable std::mutex mutex_; /*!< Mutex for queued log messages. @since 2.2.0 */
 #endif
-    size_t                      maximum_log_messages_ = MAX_LOG_MESSAGES; /*!< Maximum number of log messages to buffer before they are output. @since 1.0.0 */
-    unsigned long               log_message_id_       = 0;                /*!< The next identifier to use for queued log messages. @since 1.0.0 */
-    std::list<QueuedLogMessage> log_messages_;                            /*!< Queued log messages, in the order they were received. @since 1.0.0 */
-    uint64_t                    mark_interval_ = 0;                       /*!< Mark interval in milliseconds. @since 2.0.0 */
-    uint64_t                    last_message_  = 0;                       /*!< Last message/mark time. @since 2.0.0 */
+    unsigned long                             log_message_id_ = 0;            /*!< The next identifier to use for queued log messages. @since 1.0.0 */
+    uuid::log::MessageQueue<QueuedLogMessage> log_messages_{MAX_LOG_MESSAGES}; /*!< Queued log messages, in the order they were received. @since 1.0.0 */
+    uint64_t                                  mark_interval_ = 0;             /*!< Mark interval in milliseconds. @since 2.0.0 */
+    uint64_t                                  last_message_  = 0;             /*!< Last message/mark time. @since 2.0.0 */
 
     // added by MichaelDvP for EMS-ESP
     IPAddress     ip_;   /*!< Host to send messages to. @since 1.0.0 */
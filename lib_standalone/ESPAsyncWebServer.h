@@ -5,6 +5,7 @@
 #include "AsyncTCP.h"
 
 #include <functional>
+#include <memory>
 #include <ArduinoJson.h>
 
 class AsyncWebServer;
@@ -13,6 +14,8 @@ class AsyncWebServerResponse;
 class AsyncJsonResponse;
 class AsyncEventSource;
 
+using AsyncWebServerRequestPtr = std::weak_ptr<AsyncWebServerRequest>;
+
 class AsyncWebParameter {
   private:
     String _name;
@@ -71,6 +74,8 @@ class AsyncWebServerRequest {
 
     String _url;
 
+    std::shared_ptr<AsyncWebServerRequest> _this; // set by pause(), expires with the request
+
   public:
     void * _tempObject;
 
@@ -92,6 +97,19 @@ class AsyncWebServerRequest {
 
     void addInterestingHeader(const String & name) {};
 
+    void onDisconnect(ArDisconnectHandler fn) {};
+
+    AsyncWebServerRequestPtr pause() {
+        if (!_this) {
+            _this = std::shared_ptr<AsyncWebServerRequest>(this, [](AsyncWebServerRequest *) {});
+        }
+        return _this;
+    }
+
+    bool isPaused() const {
+        return _this != nullptr;
+    }
+
     size_t args() const {
         return 0;
     }
@@ -259,7 +277,21 @@ class AsyncEventSource : public AsyncWebHandler {
         return 0;
     };
 
-    void send(const char * message, const char * event = NULL, uint32_t id = 0, uint32_t reconnect = 0) {};
+    // a test can act as the connected client
+    using SendHandler = std::function<void(const char * message, const char * event, uint32_t id)>;
+
+    void onSend(SendHandler handler) {
+        _sendHandler = handler;
+    }
+
+    void send(const char * message, const char * event = NULL, uint32_t id = 0, uint32_t reconnect = 0) {
+        if (_sendHandler) {
+            _sendHandler(message, event, id);
+        }
+    };
+
+  private:
+    SendHandler _sendHandler;
 };
 
 
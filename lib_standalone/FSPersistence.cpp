@@ -0,0 +1,75 @@
+#include "FSPersistence.h"
+
+#include <algorithm>
+
+uint32_t FSPersistenceBase::_writes       = 0;
+uint32_t FSPersistenceBase::_writesSaved  = 0;
+uint32_t FSPersistenceBase::_maxFlushTime = 0;
+
+// flushAll() runs in the web server task, loop() in the main task
+std::mutex FSPersistenceBase::_mutex;
+
+// the services are globals, the list must exist before the first one is constructed
+std::vector<FSPersistenceBase *> & FSPersistenceBase::instances() {
+    static std::vector<FSPersistenceBase *> instances;
+    return instances;
+}
+
+FSPersistenceBase::FSPersistenceBase() {
+    instances().push_back(this);
+}
+
+FSPersistenceBase::~FSPersistenceBase() {
+    auto & list = instances();
+    list.erase(std::remove(list.begin(), list.end(), this), list.end());
+}
+
+// called from the update handler, possibly in the web server task
+void FSPersistenceBase::markDirty() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    uint32_t                    now = millis();
+    if (_dirty) {
+        _writesSaved++; // merged into the pending write
+    } else {
+        _firstChange = now;
+    }
+    _lastChange = now;
+    _dirty      = true;
+}
+
+// called with the mutex held, so a file is never written by two tasks at once
+void FSPersistenceBase::flush() {
+    _dirty         = false; // a change during the write marks it dirty again
+    uint32_t start = millis();
+    writeToFS();
+    uint32_t duration = millis() - start;
+    if (duration > _maxFlushTime) {
+        _maxFlushTime = duration;
+    }
+    _writes++;
+}
+
+void FSPersistenceBase::loop() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    uint32_t                    now = millis();
+    for (auto persistence : instances()) {
+        if (persistence->_dirty && (now - persistence->_lastChange >= WRITE_DELAY_MS || now - persistence->_firstChange >= MAX_DELAY_MS)) {
+            persistence->flush();
+        }
+    }
+}
+
+// writes the file now, also when nothing is pending
+void FSPersistenceBase::write() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    flush();
+}
+
+void FSPersistenceBase::flushAll() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto persistence : instances()) {
+        if (persistence->_dirty) {
+            persistence->flush();
+        }
+    }
+}
@@ -4,8 +4,58 @@
 #include "StatefulService.h"
 #include "FS.h"
 
+#include <mutex>
+#include <vector>
+
+// Write-behind for the settings files. An update only marks the service dirty, the file is
+// written by loop() once the service had no changes for WRITE_DELAY_MS, at the latest after MAX_DELAY_MS.
+// Pending changes must be written with flushAll() before a restart, firmware upload or export.
+class FSPersistenceBase {
+  public:
+    static constexpr uint32_t WRITE_DELAY_MS = 2000;
+    static constexpr uint32_t MAX_DELAY_MS   = 30000;
+
+    static void loop();
+    static void flushAll();
+
+    // number of file writes, updates that were merged into a later write and the longest write in ms
+    static uint32_t writes() {
+        return _writes;
+    }
+    static uint32_t writesSaved() {
+        return _writesSaved;
+    }
+    static uint32_t maxFlushTime() {
+        return _maxFlushTime;
+    }
+
+    void         write();
+    virtual bool writeToFS() = 0;
+
+  protected:
+    FSPersistenceBase();
+    virtual ~FSPersistenceBase();
+
+    void markDirty();
+
+  private:
+    static std::vector<FSPersistenceBase *> & instances();
+
+    void flush();
+
+    bool     _dirty       = false;
+    uint32_t _firstChange = 0;
+    uint32_t _lastChange  = 0;
+
+    static uint32_t _writes;
+    static uint32_t _writesSaved;
+    static uint32_t _maxFlushTime;
+
+    static std::mutex _mutex; // guards the write-behind state and serializes the writes
+};
+
 template <class T>
-class FSPersistence {
+class FSPersistence : public FSPersistenceBase {
   public:
     FSPersistence(JsonStateReader<T> stateReader, JsonStateUpdater<T> stateUpdater, StatefulService<T> * statefulService, FS * fs, const char * filePath)
         : _stateReader(stateReader)
@@ -24,7 +74,7 @@ class FSPersistence {
         applyDefaults();
     }
 
-    bool writeToFS() {
+    bool writeToFS() override {
         JsonDocument jsonDocument;
         JsonObject   jsonObject = jsonDocument.to<JsonObject>();
         _statefulService->read(jsonObject, _stateReader);
@@ -40,7 +90,7 @@ class FSPersistence {
 
     void enableUpdateHandler() {
         if (!_updateHandlerId) {
-            _updateHandlerId = _statefulService->addUpdateHandler([this] { writeToFS(); });
+            _updateHandlerId = _statefulService->addUpdateHandler([this] { markDirty(); });
         }
     }
 
@@ -22,6 +22,8 @@
 
 namespace emsesp {
 
+EMSuart::TxHandler EMSuart::tx_handler_ = nullptr;
+
 /*
  * init UART0 driver
  */
@@ -46,6 +48,9 @@ void EMSuart::restart() {
  * It's a bit dirty. there is no special wait logic per tx_mode type, fifo flushes or error checking
  */
 void EMSuart::send_poll(uint8_t data) {
+    if (tx_handler_) {
+        tx_handler_(&data, 1);
+    }
 }
 
 /*
@@ -58,6 +63,12 @@ uint16_t EMSuart::transmit(uint8_t * buf, uint8_t len) {
         return EMS_TX_STATUS_OK; // nothing to send
     }
 
+    // hand over to the bus simulator if one is attached
+    if (tx_handler_) {
+        tx_handler_(buf, len);
+        return EMS_TX_STATUS_OK;
+    }
+
     // Code for when running EMS-ESP standalone without a connected ESP8266 microcontroller
     // For debugging offline
     Serial.print("UART SENDING: ");
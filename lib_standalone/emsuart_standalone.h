@@ -28,6 +28,9 @@ namespace emsesp {
 
 class EMSuart {
   public:
+    // receives everything we put on the bus, used by the bus simulator
+    using TxHandler = void (*)(const uint8_t * data, const uint8_t length);
+
     EMSuart()  = default;
     ~EMSuart() = default;
 
@@ -39,9 +42,14 @@ class EMSuart {
     static uint8_t  last_tx_src() {
         return 0;
     }
+    static void tx_handler(TxHandler handler) {
+        tx_handler_ = handler;
+    }
 
   private:
     static char * hextoa(char * result, const uint8_t value);
+
+    static TxHandler tx_handler_;
 };
 
 } // namespace emsesp
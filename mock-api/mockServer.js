@@ -115,7 +115,7 @@ export default () => {
               m: message
             };
             count++;
-            res.write(`data: ${JSON.stringify(data)}\n\n`);
+            res.write(`data: ${JSON.stringify([data])}\n\n`);
           }, 1000);
 
           // if client closes connection
@@ -4,8 +4,58 @@
 #include "StatefulService.h"
 #include "FS.h"
 
+#include <mutex>
+#include <vector>
+
+// Write-behind for the settings files. An update only marks the service dirty, the file is
+// written by loop() once the service had no changes for WRITE_DELAY_MS, at the latest after MAX_DELAY_MS.
+// Pending changes must be written with flushAll() before a restart, firmware upload or export.
+class FSPersistenceBase {
+  public:
+    static constexpr uint32_t WRITE_DELAY_MS = 2000;
+    static constexpr uint32_t MAX_DELAY_MS   = 30000;
+
+    static void loop();
+    static void flushAll();
+
+    // number of file writes, updates that were merged into a later write and the longest write in ms
+    static uint32_t writes() {
+        return _writes;
+    }
+    static uint32_t writesSaved() {
+        return _writesSaved;
+    }
+    static uint32_t maxFlushTime() {
+        return _maxFlushTime;
+    }
+
+    void         write();
+    virtual bool writeToFS() = 0;
+
+  protected:
+    FSPersistenceBase();
+    virtual ~FSPersistenceBase();
+
+    void markDirty();
+
+  private:
+    static std::vector<FSPersistenceBase *> & instances();
+
+    void flush();
+
+    bool     _dirty       = false;
+    uint32_t _firstChange = 0;
+    uint32_t _lastChange  = 0;
+
+    static uint32_t _writes;
+    static uint32_t _writesSaved;
+    static uint32_t _maxFlushTime;
+
+    static std::mutex _mutex; // guards the write-behind state and serializes the writes
+};
+
 template <class T>
-class FSPersistence {
+class FSPersistence : public FSPersistenceBase {
   public:
     FSPersistence(JsonStateReader<T> stateReader, JsonStateUpdater<T> stateUpdater, StatefulService<T> * statefulService, FS * fs, const char * filePath)
         : _stateReader(stateReader)
@@ -49,7 +99,7 @@ class FSPersistence {
         writeToFS(); // added to make sure the initial file is created
     }
 
-    bool writeToFS() {
+    bool writeToFS() override {
         // create and populate a new json object
         JsonDocument jsonDocument;
         JsonObject   jsonObject = jsonDocument.to<JsonObject>();
@@ -65,11 +115,17 @@ class FSPersistence {
             }
         }
 
-        // serialize it to filesystem
-        File settingsFile = _fs->open(_filePath, "w");
+        // failed to read the settings, return false
+        if (!jsonObject.size()) {
+            return false;
+        }
+
+        // serialize it to a temp file and rename it, a reset during the write leaves the old file intact
+        String tmpPath      = String(_filePath) + ".tmp";
+        File   settingsFile = _fs->open(tmpPath, "w");
 
         // failed to open file, return false
-        if (!settingsFile || !jsonObject.size()) {
+        if (!settingsFile) {
             return false;
         }
 
@@ -80,9 +136,13 @@ class FSPersistence {
         // serializeJson(jsonDocument, Serial);
         // Serial.println();
 #endif
-        serializeJson(jsonDocument, settingsFile);
+        size_t written = serializeJson(jsonDocument, settingsFile);
         settingsFile.close();
-        return true;
+        if (!written) {
+            _fs->remove(tmpPath);
+            return false;
+        }
+        return _fs->rename(tmpPath, _filePath);
     }
 
     void disableUpdateHandler() {
@@ -94,7 +154,7 @@ class FSPersistence {
 
     void enableUpdateHandler() {
         if (!_updateHandlerId) {
-            _updateHandlerId = _statefulService->addUpdateHandler([&] { writeToFS(); });
+            _updateHandlerId = _statefulService->addUpdateHandler([this] { markDirty(); });
         }
     }
 
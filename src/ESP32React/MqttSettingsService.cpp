@@ -400,6 +400,13 @@ StateUpdateResult MqttSettings::update(JsonObject root, MqttSettings & settings)
         changed = true;
     }
 #endif
+    // the HA configs retained on another broker, under another topic or with other discovery settings are not known
+    if (newSettings.host != settings.host || newSettings.port != settings.port || newSettings.base != settings.base
+        || newSettings.ha_enabled != settings.ha_enabled || newSettings.discovery_prefix != settings.discovery_prefix
+        || newSettings.discovery_type != settings.discovery_type) {
+        emsesp::EMSESP::mqtt_.ha_fingerprints_clear();
+    }
+
     // save the new settings
     settings = newSettings;
 
@@ -80,7 +80,8 @@ void UploadFileService::handleUpload(AsyncWebServerRequest * request, const Stri
                 return;
             }
 #endif
-            // it's firmware - initialize the ArduinoOTA updater
+            // it's firmware - write pending settings changes and initialize the ArduinoOTA updater
+            FSPersistenceBase::flushAll();
             if (Update.begin(filesize - sizeof(esp_image_header_t))) {
                 if (strlen(_md5.data()) == _md5.size() - 1) {
                     Update.setMD5(_md5.data());
@@ -76,6 +76,7 @@ void AnalogSensor::reload(bool get_nvs) {
         remove_ha_topic(sensor.type(), sensor.gpio());
         sensor.ha_registered = false;
     }
+    pulses_.detach_all(); // attached again below
 
     if (!analog_enabled_) {
         sensors_.clear();
@@ -189,8 +190,7 @@ void AnalogSensor::reload(bool get_nvs) {
         } else if (sensor.type() == AnalogType::COUNTER) {
             LOG_DEBUG("I/O Counter on GPIO %02d", sensor.gpio());
             pinMode(sensor.gpio(), INPUT_PULLUP);
-            sensor.polltime_ = 0;
-            sensor.poll_     = digitalRead(sensor.gpio());
+            pulses_.attach(sensor.gpio());
             if (double_t val = EMSESP::nvs_.getDouble(sensor.name().c_str(), 0)) {
                 sensor.set_value(val);
             }
@@ -198,9 +198,7 @@ void AnalogSensor::reload(bool get_nvs) {
         } else if (sensor.type() == AnalogType::TIMER || sensor.type() == AnalogType::RATE) {
             LOG_DEBUG("Timer/Rate on GPIO %02d", sensor.gpio());
             pinMode(sensor.gpio(), INPUT_PULLUP);
-            sensor.polltime_      = uuid::get_uptime();
-            sensor.last_polltime_ = uuid::get_uptime();
-            sensor.poll_          = digitalRead(sensor.gpio());
+            pulses_.attach(sensor.gpio());
             sensor.set_offset(0);
             sensor.set_value(0);
             publish_sensor(sensor);
@@ -334,12 +332,11 @@ void AnalogSensor::measure() {
         }
     }
 
-    // poll digital io every time with debounce
+    // poll digital io every time with debounce, the pulse inputs are counted by the interrupt
     // go through the list of digital sensors
     for (auto & sensor : sensors_) {
-        if (sensor.type() == AnalogType::DIGITAL_IN || sensor.type() == AnalogType::COUNTER || sensor.type() == AnalogType::TIMER
-            || sensor.type() == AnalogType::RATE) {
-            auto old_value       = sensor.value(); // remember current value before reading
+        auto old_value = sensor.value(); // remember current value before reading
+        if (sensor.type() == AnalogType::DIGITAL_IN) {
             auto current_reading = digitalRead(sensor.gpio());
             if (sensor.poll_ != current_reading) {     // check for pinchange
                 sensor.polltime_ = uuid::get_uptime(); // remember time of pinchange
@@ -348,27 +345,30 @@ void AnalogSensor::measure() {
             // debounce and check for real pinchange
             if (uuid::get_uptime() - sensor.polltime_ >= 15 && sensor.poll_ != sensor.last_reading_) {
                 sensor.last_reading_ = sensor.poll_;
-                if (sensor.type() == AnalogType::DIGITAL_IN) {
-                    sensor.set_value(sensor.poll_);
-                } else if (!sensor.poll_) { // falling edge
-                    if (sensor.type() == AnalogType::COUNTER) {
-                        sensor.set_value(old_value + sensor.factor());
-                        // EMSESP::nvs_.putDouble(sensor.name().c_str(), sensor.value());
-                    } else if (sensor.type() == AnalogType::RATE) { // default uom: Hz (1/sec) with factor 1
-                        sensor.set_value(sensor.factor() * 1000 / (sensor.polltime_ - sensor.last_polltime_));
-                    } else if (sensor.type() == AnalogType::TIMER) { // default seconds with factor 1
-                        sensor.set_value(sensor.factor() * (sensor.polltime_ - sensor.last_polltime_) / 1000);
+                sensor.set_value(sensor.poll_);
+            }
+        } else if (sensor.type() == AnalogType::COUNTER || sensor.type() == AnalogType::TIMER || sensor.type() == AnalogType::RATE) {
+            PulseCounter::Pulses pulses;
+            if (pulses_.collect(sensor.gpio(), pulses)) { // falling edges since the last pass
+                if (sensor.type() == AnalogType::COUNTER) {
+                    sensor.set_value(old_value + sensor.factor() * pulses.count);
+                } else if (sensor.type() == AnalogType::RATE) { // default uom: Hz (1/sec) with factor 1
+                    if (pulses.last_ms != pulses.since_ms) {
+                        sensor.set_value(sensor.factor() * 1000 * pulses.count / (pulses.last_ms - pulses.since_ms));
                     }
-                    sensor.last_polltime_ = sensor.polltime_;
+                } else if (sensor.type() == AnalogType::TIMER) { // default seconds with factor 1
+                    sensor.set_value(sensor.factor() * (pulses.last_ms - pulses.prev_ms) / 1000);
                 }
             }
+        } else {
+            continue;
+        }
 
-            // see if there is a change and increment # reads
-            if (old_value != sensor.value()) {
-                sensorreads_++;
-                changed_ = true;
-                publish_sensor(sensor);
-            }
+        // see if there is a change and increment # reads
+        if (old_value != sensor.value()) {
+            sensorreads_++;
+            changed_ = true;
+            publish_sensor(sensor);
         }
     }
 
@@ -498,9 +498,11 @@ void AnalogSensor::publish_sensor(const Sensor & sensor) const {
         }
         Mqtt::queue_publish(topic, result); // always publish as doubles
     }
-    char cmd[COMMAND_MAX_LENGTH];
-    snprintf(cmd, sizeof(cmd), "%s/%s", F_(analogsensor), sensor.name().c_str());
-    EMSESP::webSchedulerService.onChange(cmd);
+    if (EMSESP::webSchedulerService.has_subscriptions()) {
+        char cmd[COMMAND_MAX_LENGTH];
+        snprintf(cmd, sizeof(cmd), "%s/%s", F_(analogsensor), sensor.name().c_str());
+        EMSESP::webSchedulerService.onChange(cmd);
+    }
 }
 
 // send empty config topic to remove the entry from HA
@@ -22,6 +22,7 @@
 #include "helpers.h"
 #include "mqtt.h"
 #include "console.h"
+#include "pulsecounter.h"
 
 #include <uuid/log.h>
 
@@ -93,11 +94,10 @@ class AnalogSensor {
 
         uint16_t analog_        = 0; // ADC - average value
         uint32_t sum_           = 0; // ADC - rolling sum
-        uint16_t last_reading_  = 0; // IO COUNTER & ADC - last reading
-        uint16_t count_         = 0; // counter raw counts
-        uint32_t polltime_      = 0; // digital IO & COUNTER debounce time
-        int      poll_          = 0;
-        uint32_t last_polltime_ = 0; // for timer
+        uint16_t last_reading_ = 0; // digital IO & ADC - last reading
+        uint16_t count_        = 0; // counter raw counts
+        uint32_t polltime_     = 0; // digital IO debounce time
+        int      poll_         = 0;
 
       private:
         uint8_t     gpio_;
@@ -167,6 +167,13 @@ class AnalogSensor {
     bool get_value_info(JsonObject output, const char * cmd, const int8_t id = -1);
     void store_counters();
 
+#if defined(EMSESP_STANDALONE)
+    // simulated edges on a COUNTER, TIMER or RATE input
+    void edge(const uint8_t gpio, const int level, const uint32_t ms) {
+        pulses_.edge(gpio, level, ms);
+    }
+#endif
+
   private:
     static constexpr double   Beta                    = 4260;
     static constexpr double   T0                      = 273.15;
@@ -185,6 +192,7 @@ class AnalogSensor {
     void get_value_json(JsonObject output, const Sensor & sensor);
 
     std::vector<Sensor> sensors_; // our list of sensors
+    PulseCounter        pulses_;  // edge capture for COUNTER, TIMER and RATE
 
     bool     analog_enabled_;
     bool     changed_     = true; // this will force a publish of all sensors when initialising
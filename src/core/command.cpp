@@ -26,92 +26,140 @@ uuid::log::Logger Command::logger_{F_(command), uuid::log::Facility::DAEMON};
 
 std::vector<Command::CmdFunction> Command::cmdfunctions_;
 
+std::unordered_map<uint32_t, Command::CommandRoute> Command::routes_;
+std::mutex                                          Command::routes_mutex_;
+
 // takes a URI path and a json body, parses the data and calls the command
 // the path is leading so if duplicate keys are in the input JSON it will be ignored
 // the entry point will be either via the Web API (api/) or MQTT (<base>/)
 // returns a return code and json output
 uint8_t Command::process(const char * path, const bool is_admin, const JsonObject input, JsonObject output) {
     // check for MQTT, if so strip the "<base>" from the path
-    if (!strncmp(path, Mqtt::base().c_str(), Mqtt::base().length())) {
-        path += Mqtt::base().length();
+    const std::string & base = Mqtt::base();
+    if (!strncmp(path, base.c_str(), base.length())) {
+        path += base.length();
     }
-    SUrlParser p; // parse URL for the path names
-    p.parse(path);
 
-    // check if it's from API
-    if (p.paths().size() && ((p.paths().front() == "api"))) {
-        p.paths().erase(p.paths().begin());
-    } else if (!p.paths().size()) {
-        return json_message(CommandRet::ERROR, "invalid path", output, path); // error
+    uint8_t      device_type;
+    int8_t       id_n      = -1; // default hc
+    const char * command_p = nullptr;
+    char         command[COMMAND_MAX_LENGTH];
+
+    // paths with the device and command were parsed before, take them from the cache
+    // the command is copied, another task may clear the cache while this one is still running
+    uint32_t path_hash = Helpers::hash(path);
+    bool     cached    = false;
+    {
+        std::lock_guard<std::mutex> lock(routes_mutex_);
+        auto                        route = routes_.find(path_hash);
+        if (route != routes_.end() && route->second.path == path) {
+            device_type = route->second.device_type;
+            id_n        = route->second.id;
+            strlcpy(command, route->second.command.c_str(), sizeof(command));
+            command_p = command;
+            cached    = true;
+        }
     }
+    if (cached) {
+        if (!device_has_commands(device_type)) {
+            char err[100];
+            snprintf(err, sizeof(err), "unknown device %s", EMSdevice::device_type_2_device_name(device_type));
+            LOG_WARNING("Command failed: %s", err);
+            output["message"] = err;
+            return CommandRet::NOT_FOUND;
+        }
+    } else {
+        SUrlParser p; // parse URL for the path names
+        p.parse(path);
+
+        // check if it's from API
+        if (p.paths().size() && ((p.paths().front() == "api"))) {
+            p.paths().erase(p.paths().begin());
+        } else if (!p.paths().size()) {
+            return json_message(CommandRet::ERROR, "invalid path", output, path); // error
+        }
 
-    // re-calculate new path
-    // if there is only a path (URL) and no body then error!
-    size_t num_paths = p.paths().size();
-    if (!num_paths && !input.size()) {
-        return json_message(CommandRet::ERROR, "missing command in path", output);
-    }
+        // re-calculate new path
+        // if there is only a path (URL) and no body then error!
+        size_t num_paths = p.paths().size();
+        if (!num_paths && !input.size()) {
+            return json_message(CommandRet::ERROR, "missing command in path", output);
+        }
 
-    std::string cmd_s;
-    int8_t      id_n = -1; // default hc
+        // check for a device as first item in the path
+        const char * device_s = nullptr;
+        if (!num_paths) {
+            // we must look for the device in the JSON body
+            if (input["device"].is<const char *>()) {
+                device_s = input["device"];
+            }
+        } else {
+            // extract it from the path
+            device_s = p.paths().front().c_str(); // get the device type name (boiler, thermostat, system etc)
+        }
 
-    // check for a device as first item in the path
-    const char * device_s = nullptr;
-    if (!num_paths) {
-        // we must look for the device in the JSON body
-        if (input["device"].is<const char *>()) {
-            device_s = input["device"];
+        // validate the device, make sure it exists
+        device_type = EMSdevice::device_name_2_device_type(device_s);
+        if (!device_has_commands(device_type)) {
+            char err[100];
+            snprintf(err, sizeof(err), "unknown device %s", device_s);
+            LOG_WARNING("Command failed: %s", err);
+            output["message"] = err;
+            return CommandRet::NOT_FOUND;
         }
-    } else {
-        // extract it from the path
-        device_s = p.paths().front().c_str(); // get the device type name (boiler, thermostat, system etc)
-    }
 
-    // validate the device, make sure it exists
-    uint8_t device_type = EMSdevice::device_name_2_device_type(device_s);
-    if (!device_has_commands(device_type)) {
-        char err[100];
-        snprintf(err, sizeof(err), "unknown device %s", device_s);
-        LOG_WARNING("Command failed: %s", err);
-        output["message"] = err;
-        return CommandRet::NOT_FOUND;
-    }
+        // the next value on the path should be the command or entity name
+        if (num_paths == 2) {
+            command_p = p.paths()[1].c_str();
+        } else if (num_paths == 3) {
+            // concatenate the path into one string as it could be in the format 'hc/XXX'
+            snprintf(command, sizeof(command), "%s/%s", p.paths()[1].c_str(), p.paths()[2].c_str());
+            command_p = command;
+        } else if (num_paths > 3) {
+            // concatenate the path into one string as it could be in the format 'hc/XXX/attribute'
+            snprintf(command, sizeof(command), "%s/%s/%s", p.paths()[1].c_str(), p.paths()[2].c_str(), p.paths()[3].c_str());
+            command_p = command;
+        } else {
+            // take it from the JSON
+            if (input["entity"].is<const char *>()) {
+                command_p = input["entity"];
+            } else if (input["cmd"].is<const char *>()) {
+                command_p = input["cmd"];
+            }
+        }
 
-    // the next value on the path should be the command or entity name
-    const char * command_p = nullptr;
-    if (num_paths == 2) {
-        command_p = p.paths()[1].c_str();
-    } else if (num_paths == 3) {
-        // concatenate the path into one string as it could be in the format 'hc/XXX'
-        char command[COMMAND_MAX_LENGTH];
-        snprintf(command, sizeof(command), "%s/%s", p.paths()[1].c_str(), p.paths()[2].c_str());
-        command_p = command;
-    } else if (num_paths > 3) {
-        // concatenate the path into one string as it could be in the format 'hc/XXX/attribute'
-        char command[COMMAND_MAX_LENGTH];
-        snprintf(command, sizeof(command), "%s/%s/%s", p.paths()[1].c_str(), p.paths()[2].c_str(), p.paths()[3].c_str());
-        command_p = command;
-    } else {
-        // take it from the JSON
-        if (input["entity"].is<const char *>()) {
-            command_p = input["entity"];
-        } else if (input["cmd"].is<const char *>()) {
-            command_p = input["cmd"];
+        // some commands may be prefixed with hc. dhw. or hc/ or dhw/ so extract these if they exist
+        // parse_command_string returns the extracted command
+        if (device_type >= EMSdevice::DeviceType::BOILER) {
+            command_p = parse_command_string(command_p, id_n);
+        }
+        if (command_p == nullptr) {
+            // handle dead endpoints like api/system or api/boiler
+            // default to 'value' for all devices
+            if (num_paths < (id_n > 0 ? 4 : 3)) {
+                command_p = F_(values);
+            } else {
+                return json_message(CommandRet::NOT_FOUND, "missing or bad command", output);
+            }
         }
-    }
 
-    // some commands may be prefixed with hc. dhw. or hc/ or dhw/ so extract these if they exist
-    // parse_command_string returns the extracted command
-    if (device_type >= EMSdevice::DeviceType::BOILER) {
-        command_p = parse_command_string(command_p, id_n);
-    }
-    if (command_p == nullptr) {
-        // handle dead endpoints like api/system or api/boiler
-        // default to 'value' for all devices
-        if (num_paths < (id_n > 0 ? 4 : 3)) {
-            command_p = F_(values);
-        } else {
-            return json_message(CommandRet::NOT_FOUND, "missing or bad command", output);
+        // the route only depends on the path if the command is in it
+        if (num_paths >= 2) {
+            // p goes out of scope, move the command into the local buffer, it may already point into it
+            size_t len = strnlen(command_p, sizeof(command) - 1);
+            memmove(command, command_p, len);
+            command[len] = '\0';
+            command_p    = command;
+
+            std::lock_guard<std::mutex> lock(routes_mutex_);
+            if (routes_.size() >= MAX_ROUTES) {
+                routes_.clear();
+            }
+            auto & r      = routes_[path_hash];
+            r.path        = path;
+            r.device_type = device_type;
+            r.id          = id_n;
+            r.command     = command;
         }
     }
 
@@ -19,6 +19,7 @@
 #ifndef EMSESP_COMMAND_H_
 #define EMSESP_COMMAND_H_
 
+#include <mutex>
 #include <unordered_map>
 
 #include "console.h"
@@ -146,6 +147,19 @@ class Command {
 
     static std::vector<CmdFunction> cmdfunctions_; // the list of commands
 
+    // device, id and command parsed from a path, e.g. a MQTT command topic
+    struct CommandRoute {
+        std::string path;
+        uint8_t     device_type;
+        int8_t      id;
+        std::string command;
+    };
+
+    static constexpr size_t MAX_ROUTES = 64; // cleared when full
+
+    static std::unordered_map<uint32_t, CommandRoute> routes_;       // by hash of the path
+    static std::mutex                                  routes_mutex_; // commands come from the web server, scheduler, modbus and MQTT tasks
+
     static uint8_t json_message(uint8_t error_code, const char * message, JsonObject output, const char * object = nullptr);
 };
 
@@ -23,17 +23,21 @@
 
 using uuid::log::Level;
 
+// the level is checked before the arguments are evaluated, so expensive arguments like pretty_telegram() or
+// data_to_hex() are only built when a log handler (console, web, syslog) will consume them
+#define LOG_LEVEL_(level, func, ...) (logger_.enabled(uuid::log::Level::level) ? logger_.func(__VA_ARGS__) : (void)0)
+
 #if defined(EMSESP_DEBUG)
-#define LOG_DEBUG(...) logger_.debug(__VA_ARGS__)
+#define LOG_DEBUG(...) LOG_LEVEL_(DEBUG, debug, __VA_ARGS__)
 #else
 #define LOG_DEBUG(...)
 #endif
 
-#define LOG_INFO(...) logger_.info(__VA_ARGS__)
-#define LOG_TRACE(...) logger_.trace(__VA_ARGS__)
-#define LOG_NOTICE(...) logger_.notice(__VA_ARGS__)
-#define LOG_WARNING(...) logger_.warning(__VA_ARGS__)
-#define LOG_ERROR(...) logger_.err(__VA_ARGS__)
+#define LOG_INFO(...) LOG_LEVEL_(INFO, info, __VA_ARGS__)
+#define LOG_TRACE(...) LOG_LEVEL_(TRACE, trace, __VA_ARGS__)
+#define LOG_NOTICE(...) LOG_LEVEL_(NOTICE, notice, __VA_ARGS__)
+#define LOG_WARNING(...) LOG_LEVEL_(WARNING, warning, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_LEVEL_(ERR, err, __VA_ARGS__)
 
 // flash strings
 using uuid::string_vector;
@@ -53,24 +57,31 @@ using string_vector = std::vector<const char *>;
 #define FL_(list_name) (__pstr__L_##list_name)
 
 // The language settings below must match system.cpp
+// Each list has a slot for every language, unused slots are nullptr, so a translation is looked up by
+// the language index without checking the length. A word list ends with a nullptr, a translation with
+// the shortname in front has one slot more
 #if defined(EMSESP_TEST)
 // in Test mode use two languages (en & de) to save flash memory needed for the tests
-#define MAKE_WORD_TRANSLATION(list_name, en, de, ...)       static const char * const __pstr__L_##list_name[] = {en, de, nullptr};
-#define MAKE_TRANSLATION(list_name, shortname, en, de, ...) static const char * const __pstr__L_##list_name[] = {shortname, en, de, nullptr};
+#define EMSESP_LANGUAGES 2
+#define MAKE_WORD_TRANSLATION(list_name, en, de, ...)       static const char * const __pstr__L_##list_name[EMSESP_LANGUAGES + 1] = {en, de, nullptr};
+#define MAKE_TRANSLATION(list_name, shortname, en, de, ...) static const char * const __pstr__L_##list_name[EMSESP_LANGUAGES + 2] = {shortname, en, de, nullptr};
 #elif defined(EMSESP_EN_ONLY)
 // EN only
-#define MAKE_WORD_TRANSLATION(list_name, en, ...)       static const char * const __pstr__L_##list_name[] = {en, nullptr};
-#define MAKE_TRANSLATION(list_name, shortname, en, ...) static const char * const __pstr__L_##list_name[] = {shortname, en, nullptr};
+#define EMSESP_LANGUAGES 1
+#define MAKE_WORD_TRANSLATION(list_name, en, ...)       static const char * const __pstr__L_##list_name[EMSESP_LANGUAGES + 1] = {en, nullptr};
+#define MAKE_TRANSLATION(list_name, shortname, en, ...) static const char * const __pstr__L_##list_name[EMSESP_LANGUAGES + 2] = {shortname, en, nullptr};
 #elif defined(EMSESP_DE_ONLY)
 // EN + DE
-#define MAKE_WORD_TRANSLATION(list_name, en, de, ...)       static const char * const __pstr__L_##list_name[] = {en, de, nullptr};
-#define MAKE_TRANSLATION(list_name, shortname, en, de, ...) static const char * const __pstr__L_##list_name[] = {shortname, en, de, nullptr};
+#define EMSESP_LANGUAGES 2
+#define MAKE_WORD_TRANSLATION(list_name, en, de, ...)       static const char * const __pstr__L_##list_name[EMSESP_LANGUAGES + 1] = {en, de, nullptr};
+#define MAKE_TRANSLATION(list_name, shortname, en, de, ...) static const char * const __pstr__L_##list_name[EMSESP_LANGUAGES + 2] = {shortname, en, de, nullptr};
 #else
-#define MAKE_WORD_TRANSLATION(list_name, ...) static const char * const __pstr__L_##list_name[] = {__VA_ARGS__, nullptr};
-#define MAKE_TRANSLATION(list_name, ...)      static const char * const __pstr__L_##list_name[] = {__VA_ARGS__, nullptr};
+#define EMSESP_LANGUAGES 11
+#define MAKE_WORD_TRANSLATION(list_name, ...) static const char * const __pstr__L_##list_name[EMSESP_LANGUAGES + 1] = {__VA_ARGS__};
+#define MAKE_TRANSLATION(list_name, ...)      static const char * const __pstr__L_##list_name[EMSESP_LANGUAGES + 2] = {__VA_ARGS__};
 #endif
 
-#define MAKE_NOTRANSLATION(list_name, ...) static const char * const __pstr__L_##list_name[] = {__VA_ARGS__, nullptr};
+#define MAKE_NOTRANSLATION(list_name, ...) static const char * const __pstr__L_##list_name[EMSESP_LANGUAGES + 1] = {__VA_ARGS__, nullptr};
 
 // fixed strings, no translations
 #define MAKE_ENUM_FIXED(enum_name, ...) static const char * const __pstr__L_##enum_name[] = {__VA_ARGS__, nullptr};
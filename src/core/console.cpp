@@ -100,12 +100,16 @@ static void setup_commands(std::shared_ptr<Commands> const & commands) {
                 EMSESP::show_sensor_values(shell);
             } else if (command == F_(mqtt)) {
                 Mqtt::show_mqtt(shell);
+            } else if (command == F_(perf)) {
+                Profiler::show(shell);
+            } else if (command == F_(latency)) {
+                Latency::show(shell);
             } else {
                 shell.printfln("Unknown show command");
             }
         },
         [](Shell const & shell, const std::vector<std::string> & current_arguments, const std::string & next_argument) -> std::vector<std::string> {
-            return std::vector<std::string>{"system", "users", "devices", "log", "ems", "values", "mqtt", "commands"};
+            return std::vector<std::string>{"system", "users", "devices", "log", "ems", "values", "mqtt", "perf", "latency", "commands"};
         });
 
 
@@ -21,6 +21,9 @@
 
 namespace emsesp {
 
+uint32_t EMSdevice::fetch_requests_ = 0;
+uint32_t EMSdevice::fetch_skipped_  = 0;
+
 // returns number of visible device values (entities) for this device, for the Devices page
 // this includes commands since they can also be entities and visible in the web UI
 uint8_t EMSdevice::count_entities() {
@@ -337,7 +340,8 @@ std::string EMSdevice::to_string_short() {
 }
 
 // for each telegram that has the fetch value set (true) do a read request
-void EMSdevice::fetch_values() {
+// only_stale skips the telegrams that were received or broadcasted recently enough, used by the scheduled fetch
+void EMSdevice::fetch_values(const bool only_stale) {
     if (!active_) {
         return;
     }
@@ -345,8 +349,14 @@ void EMSdevice::fetch_values() {
     EMSESP::logger().debug("Fetching values for deviceID 0x%02X", device_id());
 #endif
 
+    uint32_t now = uuid::get_uptime();
     for (const auto & tf : telegram_functions_) {
         if (tf.fetch_) {
+            if (only_stale && !tf.stale(now)) {
+                fetch_skipped_++;
+                continue;
+            }
+            fetch_requests_++;
             read_command(tf.telegram_type_id_);
         }
     }
@@ -367,22 +377,14 @@ void EMSdevice::toggle_fetch(uint16_t telegram_id, bool toggle) {
 
 // get status of automatic fetch for a telegramID
 bool EMSdevice::is_fetch(uint16_t telegram_id) const {
-    for (const auto & tf : telegram_functions_) {
-        if (tf.telegram_type_id_ == telegram_id) {
-            return tf.fetch_;
-        }
-    }
-    return false;
+    auto tf = find_telegram_function(telegram_id);
+    return tf && tf->fetch_;
 }
 
 // get receive status of telegramID
 bool EMSdevice::is_received(uint16_t telegram_id) const {
-    for (const auto & tf : telegram_functions_) {
-        if (tf.telegram_type_id_ == telegram_id) {
-            return tf.received_;
-        }
-    }
-    return false;
+    auto tf = find_telegram_function(telegram_id);
+    return tf && tf->received_;
 }
 
 // check for a tag to create a nest
@@ -397,7 +399,9 @@ bool EMSdevice::has_tags(const int8_t tag) const {
 
 // check if the device has a command with this tag.
 bool EMSdevice::has_cmd(const char * cmd, const int8_t id) const {
-    for (const auto & dv : devicevalues_) {
+    auto range = dv_name_range(cmd);
+    for (auto it = range.first; it != range.second; ++it) {
+        const auto & dv = devicevalues_[*it];
         if ((id < 1 || dv.tag == id) && dv.has_cmd && strcmp(dv.short_name, cmd) == 0 && (dv.hasValue() || dv.type == DeviceValueType::CMD)) {
             return true;
         }
@@ -528,6 +532,19 @@ void EMSdevice::show_mqtt_handlers(uuid::console::Shell & shell) const {
 // register a callback function for a specific telegram type
 void EMSdevice::register_telegram_type(const uint16_t telegram_type_id, const char * telegram_type_name, bool fetch, const process_function_p f) {
     telegram_functions_.emplace_back(telegram_type_id, telegram_type_name, fetch, false, f);
+    // index the handler. If the type_id is registered twice the first one wins, same as a linear scan would
+    telegram_index_.emplace(telegram_type_id, telegram_functions_.size() - 1);
+}
+
+// returns the registered handler for a telegram type_id, or nullptr
+const EMSdevice::TelegramFunction * EMSdevice::find_telegram_function(const uint16_t telegram_type_id) const {
+    auto it = telegram_index_.find(telegram_type_id);
+    return (it == telegram_index_.end()) ? nullptr : &telegram_functions_[it->second];
+}
+
+EMSdevice::TelegramFunction * EMSdevice::find_telegram_function(const uint16_t telegram_type_id) {
+    auto it = telegram_index_.find(telegram_type_id);
+    return (it == telegram_index_.end()) ? nullptr : &telegram_functions_[it->second];
 }
 
 // add to device value library, also know now as a "device entity"
@@ -586,40 +603,20 @@ void EMSdevice::add_device_value(int8_t                tag,              // to b
         fullname = &name[1]; // translations start at index 1
     }
 
-    // scan through customizations to see if it's on the exclusion list by matching the productID and deviceID
-    EMSESP::webCustomizationService.read([&](WebCustomization & settings) {
-        for (EntityCustomization entityCustomization : settings.entityCustomizations) {
-            if ((entityCustomization.product_id == product_id()) && (entityCustomization.device_id == device_id())) {
-                char entity[70];
-                if (tag < DeviceValueTAG::TAG_HC1) {
-                    strncpy(entity, short_name, sizeof(entity) - 1);
-                } else {
-                    snprintf(entity, sizeof(entity), "%s/%s", tag_to_mqtt(tag), short_name);
-                }
-
-                for (const std::string & entity_id : entityCustomization.entity_ids) {
-                    // if there is an appended custom name, strip it to get the true entity name
-                    // and extract the new custom name
-                    auto        custom_name_pos = entity_id.find('|');
-                    bool        has_custom_name = (custom_name_pos != std::string::npos);
-                    std::string shortname       = has_custom_name ? entity_id.substr(2, custom_name_pos - 2) : entity_id.substr(2);
-
-                    // we found the device entity
-                    if (shortname == entity) {
-                        // get Mask
-                        uint8_t mask = Helpers::hextoint(entity_id.substr(0, 2).c_str());
-                        state        = mask << 4;             // set state high bits to flag, turn off active and ha flags
-                        ignore       = (mask & 0x80) == 0x80; // do not register
-                        // see if there is a custom name in the entity string
-                        if (has_custom_name) {
-                            custom_fullname = entity_id.substr(custom_name_pos + 1);
-                        }
-                        break;
-                    }
-                }
-            }
+    // see if the entity is customized for this productID and deviceID
+    if (!customizations_loaded_) {
+        load_customizations();
+    }
+    char entity[70];
+    entity_name(entity, sizeof(entity), tag, short_name);
+    auto custom = find_customization(customizations_, entity);
+    if (custom) {
+        state  = custom->mask << 4;            // set state high bits to flag, turn off active and ha flags
+        ignore = (custom->mask & 0x80) == 0x80; // do not register
+        if (custom->has_custom_name) {
+            custom_fullname = custom->custom_fullname;
         }
-    });
+    }
 
     if (ignore) {
         return;
@@ -628,6 +625,7 @@ void EMSdevice::add_device_value(int8_t                tag,              // to b
     // add the device entity
     devicevalues_.emplace_back(
         device_type_, tag, value_p, type, options, options_single, numeric_operator, short_name, fullname, custom_fullname, uom, has_cmd, min, max, state);
+    index_device_value(devicevalues_.size() - 1);
 
     // add a new command if it has a function attached
     if (has_cmd) {
@@ -744,12 +742,59 @@ void EMSdevice::register_device_value(int8_t tag, void * value_p, uint8_t type,
     add_device_value(tag, value_p, type, options, nullptr, 0, name, uom, nullptr, 0, 0);
 }
 
+// add a new device value to the lookup indexes
+// inserting after all equal keys keeps entities with the same name or value_p in registration order
+void EMSdevice::index_device_value(const uint16_t dv_index) {
+    auto name_it = std::upper_bound(dv_name_index_.begin(), dv_name_index_.end(), dv_index, [&](const uint16_t a, const uint16_t b) {
+        return strcasecmp(devicevalues_[a].short_name, devicevalues_[b].short_name) < 0;
+    });
+    dv_name_index_.insert(name_it, dv_index);
+
+    auto value_it = std::upper_bound(dv_value_index_.begin(), dv_value_index_.end(), dv_index, [&](const uint16_t a, const uint16_t b) {
+        return std::less<const void *>()(devicevalues_[a].value_p, devicevalues_[b].value_p);
+    });
+    dv_value_index_.insert(value_it, dv_index);
+}
+
+// all device values with this short name, ignoring case, in registration order
+EMSdevice::dv_index_range EMSdevice::dv_name_range(const char * short_name) const {
+    auto first = std::lower_bound(dv_name_index_.begin(), dv_name_index_.end(), short_name, [&](const uint16_t a, const char * name) {
+        return strcasecmp(devicevalues_[a].short_name, name) < 0;
+    });
+    auto last = std::upper_bound(first, dv_name_index_.end(), short_name, [&](const char * name, const uint16_t a) {
+        return strcasecmp(name, devicevalues_[a].short_name) < 0;
+    });
+    return {first, last};
+}
+
+// all device values pointing to value_p, in registration order
+EMSdevice::dv_index_range EMSdevice::dv_value_range(const void * value_p) const {
+    auto first = std::lower_bound(dv_value_index_.begin(), dv_value_index_.end(), value_p, [&](const uint16_t a, const void * v) {
+        return std::less<const void *>()(devicevalues_[a].value_p, v);
+    });
+    auto last = std::upper_bound(first, dv_value_index_.end(), value_p, [&](const void * v, const uint16_t a) {
+        return std::less<const void *>()(v, devicevalues_[a].value_p);
+    });
+    return {first, last};
+}
+
+// find a device value by its tag and exact short name, returns nullptr if not found
+DeviceValue * EMSdevice::find_device_value(const int8_t tag, const char * short_name) {
+    auto range = dv_name_range(short_name);
+    for (auto it = range.first; it != range.second; ++it) {
+        auto & dv = devicevalues_[*it];
+        if (dv.tag == tag && strcmp(dv.short_name, short_name) == 0) {
+            return &dv;
+        }
+    }
+    return nullptr;
+}
+
 // check if value is readable via mqtt/api
 bool EMSdevice::is_readable(const void * value_p) const {
-    for (const auto & dv : devicevalues_) {
-        if (dv.value_p == value_p) {
-            return !dv.has_state(DeviceValueState::DV_API_MQTT_EXCLUDE);
-        }
+    auto range = dv_value_range(value_p);
+    if (range.first != range.second) {
+        return !devicevalues_[*range.first].has_state(DeviceValueState::DV_API_MQTT_EXCLUDE);
     }
     return false;
 }
@@ -757,9 +802,11 @@ bool EMSdevice::is_readable(const void * value_p) const {
 // check if value/command is readonly
 // matches valid tags too
 bool EMSdevice::is_readonly(const std::string & cmd, const int8_t id) const {
-    for (const auto & dv : devicevalues_) {
+    auto range = dv_name_range(cmd.c_str());
+    for (auto it = range.first; it != range.second; ++it) {
+        const auto & dv = devicevalues_[*it];
         // check command name and tag, id -1 is default hc and only checks name
-        if (dv.has_cmd && std::string(dv.short_name) == cmd && (dv.tag < DeviceValueTAG::TAG_HC1 || dv.tag == id || id == -1)) {
+        if (dv.has_cmd && dv.short_name == cmd && (dv.tag < DeviceValueTAG::TAG_HC1 || dv.tag == id || id == -1)) {
             return dv.has_state(DeviceValueState::DV_READONLY);
         }
     }
@@ -768,35 +815,42 @@ bool EMSdevice::is_readonly(const std::string & cmd, const int8_t id) const {
 
 // check if value has a registered command
 bool EMSdevice::has_command(const void * value_p) const {
-    for (const auto & dv : devicevalues_) {
-        if (dv.value_p == value_p) {
-            return dv.has_cmd && !dv.has_state(DeviceValueState::DV_READONLY);
-        }
+    auto range = dv_value_range(value_p);
+    if (range.first != range.second) {
+        const auto & dv = devicevalues_[*range.first];
+        return dv.has_cmd && !dv.has_state(DeviceValueState::DV_READONLY);
     }
     return false;
 }
 
 // set min and max
 void EMSdevice::set_minmax(const void * value_p, int16_t min, uint32_t max) {
-    for (auto & dv : devicevalues_) {
-        if (dv.value_p == value_p) {
-            dv.min = min;
-            dv.max = max;
-            dv.set_custom_minmax(); // custom priority
-            return;
-        }
+    auto range = dv_value_range(value_p);
+    if (range.first != range.second) {
+        auto & dv = devicevalues_[*range.first];
+        dv.min    = min;
+        dv.max    = max;
+        dv.set_custom_minmax(); // custom priority
     }
 }
 
 // publish a single value on change
-void EMSdevice::publish_value(void * value_p) const {
+void EMSdevice::publish_value(void * value_p) {
     // if (!Mqtt::publish_single() || value_p == nullptr) {
     if (value_p == nullptr) {
         return;
     }
 
-    for (const auto & dv : devicevalues_) {
-        if (dv.value_p == value_p && !dv.has_state(DeviceValueState::DV_API_MQTT_EXCLUDE)) {
+    auto range = dv_value_range(value_p);
+    for (auto it = range.first; it != range.second; ++it) {
+        const auto & dv = devicevalues_[*it];
+        if (!dv.has_state(DeviceValueState::DV_API_MQTT_EXCLUDE)) {
+            if (dv.tag >= DeviceValueTAG::TAG_DEVICE_DATA) {
+                changed_tags_ |= (uint64_t)1 << dv.tag;
+            }
+            if (!changed_since_) {
+                changed_since_ = Latency::received();
+            }
             char topic[Mqtt::MQTT_TOPIC_MAX_SIZE];
             if (Mqtt::publish_single2cmd()) {
                 if (dv.tag >= DeviceValueTAG::TAG_HC1) {
@@ -863,20 +917,24 @@ void EMSdevice::publish_value(void * value_p) const {
                 Mqtt::queue_publish(topic, payload);
             }
             // check scheduler for on change
-            char cmd[COMMAND_MAX_LENGTH];
-            if (dv.tag >= DeviceValueTAG::TAG_HC1) {
-                snprintf(cmd, sizeof(cmd), "%s/%s/%s", device_type_2_device_name(device_type_), tag_to_mqtt(dv.tag), dv.short_name);
-            } else {
-                snprintf(cmd, sizeof(cmd), "%s/%s", device_type_2_device_name(device_type_), (dv.short_name));
+            if (EMSESP::webSchedulerService.has_subscriptions()) {
+                char cmd[COMMAND_MAX_LENGTH];
+                if (dv.tag >= DeviceValueTAG::TAG_HC1) {
+                    snprintf(cmd, sizeof(cmd), "%s/%s/%s", device_type_2_device_name(device_type_), tag_to_mqtt(dv.tag), dv.short_name);
+                } else {
+                    snprintf(cmd, sizeof(cmd), "%s/%s", device_type_2_device_name(device_type_), (dv.short_name));
+                }
+                EMSESP::webSchedulerService.onChange(cmd);
             }
-            EMSESP::webSchedulerService.onChange(cmd);
         }
     }
 }
 
 // looks up the UOM for a given key from the device value table
 std::string EMSdevice::get_value_uom(const std::string & shortname) const {
-    for (const auto & dv : devicevalues_) {
+    auto range = dv_name_range(shortname.c_str());
+    for (auto it = range.first; it != range.second; ++it) {
+        const auto & dv = devicevalues_[*it];
         if ((!dv.has_state(DeviceValueState::DV_WEB_EXCLUDE)) && (dv.short_name == shortname)) {
             // ignore TIME since "minutes" is already added to the string value
             if ((dv.uom == DeviceValueUOM::NONE) || (dv.uom == DeviceValueUOM::MINUTES)) {
@@ -1189,98 +1247,149 @@ void EMSdevice::set_climate_minmax(int8_t tag, int16_t min, uint32_t max) {
 }
 
 void EMSdevice::setValueEnum(const void * value_p, const char * const ** options) {
-    for (auto & dv : devicevalues_) {
-        if (dv.value_p == value_p) {
-            if (dv.options != options && Mqtt::ha_enabled()) {
-                dv.remove_state(DeviceValueState::DV_HA_CONFIG_CREATED);
-            }
-            dv.options      = options;
-            dv.options_size = Helpers::count_items(options);
-            break;
+    auto range = dv_value_range(value_p);
+    if (range.first != range.second) {
+        auto & dv = devicevalues_[*range.first];
+        if (dv.options != options && Mqtt::ha_enabled()) {
+            dv.remove_state(DeviceValueState::DV_HA_CONFIG_CREATED);
         }
+        dv.options      = options;
+        dv.options_size = Helpers::count_items(options);
     }
 }
 
-// set mask per device entity based on the id which is prefixed with the 2 char hex mask value
-// returns true if the entity has a mask set (not 0 the default)
-void EMSdevice::setCustomizationEntity(const std::string & entity_id) {
-    for (auto & dv : devicevalues_) {
-        char entity_name[70];
-        if (dv.tag < DeviceValueTAG::TAG_HC1) {
-            strncpy(entity_name, dv.short_name, sizeof(entity_name) - 1);
-        } else {
-            snprintf(entity_name, sizeof(entity_name), "%s/%s", tag_to_mqtt(dv.tag), dv.short_name);
-        }
+// entity name with the tag prefix, as used in the customizations, e.g. hc1/seltemp
+void EMSdevice::entity_name(char * name, const size_t len, const int8_t tag, const char * short_name) {
+    if (tag < DeviceValueTAG::TAG_HC1) {
+        snprintf(name, len, "%s", short_name);
+    } else {
+        snprintf(name, len, "%s/%s", tag_to_mqtt(tag), short_name);
+    }
+}
 
-        // extra shortname
-        auto        custom_name_pos = entity_id.find('|');
-        bool        has_custom_name = (custom_name_pos != std::string::npos);
-        std::string shortname       = has_custom_name ? entity_id.substr(2, custom_name_pos - 2) : entity_id.substr(2);
+// parses entity ids, which are the 2 char hex mask value followed by the entity name and an optional |custom fullname
+// the result is sorted by entity name, on duplicates the first one is found
+void EMSdevice::parse_customizations(const std::vector<std::string> & entity_ids, std::vector<EntityCustom> & customizations) {
+    customizations.reserve(customizations.size() + entity_ids.size());
+    for (const auto & entity_id : entity_ids) {
+        if (entity_id.size() < 2) {
+            continue;
+        }
+        auto         custom_name_pos = entity_id.find('|');
+        EntityCustom custom;
+        custom.has_custom_name = (custom_name_pos != std::string::npos);
+        custom.name            = entity_id.substr(2, custom.has_custom_name ? custom_name_pos - 2 : std::string::npos);
+        if (custom.has_custom_name) {
+            custom.custom_fullname = entity_id.substr(custom_name_pos + 1);
+        }
+        char mask[3] = {entity_id[0], entity_id[1], '\0'};
+        custom.mask  = Helpers::hextoint(mask);
+        customizations.push_back(std::move(custom));
+    }
+    std::stable_sort(customizations.begin(), customizations.end(), [](const EntityCustom & a, const EntityCustom & b) { return a.name < b.name; });
+}
 
-        if (entity_name == shortname) {
-            // check the masks
-            uint8_t current_mask = dv.state >> 4;
-            uint8_t new_mask     = Helpers::hextoint(entity_id.substr(0, 2).c_str()); // first character contains mask flags
+const EMSdevice::EntityCustom * EMSdevice::find_customization(const std::vector<EntityCustom> & customizations, const char * name) {
+    auto it = std::lower_bound(customizations.begin(), customizations.end(), name, [](const EntityCustom & custom, const char * name) {
+        return strcmp(custom.name.c_str(), name) < 0;
+    });
+    return (it != customizations.end() && it->name == name) ? &*it : nullptr;
+}
 
-            // if it's a new mask, reconfigure HA
-            if (Mqtt::ha_enabled() && (has_custom_name || ((current_mask ^ new_mask) & (DeviceValueState::DV_READONLY >> 4)))) {
-                // remove ha config on change of dv_readonly flag
-                dv.remove_state(DeviceValueState::DV_HA_CONFIG_CREATED);
-                Mqtt::publish_ha_sensor_config_dv(dv, "", "", "", true); // delete topic (remove = true)
+// parse the customizations of this device once for registering its entities
+void EMSdevice::load_customizations() {
+    customizations_.clear();
+    EMSESP::webCustomizationService.read([&](WebCustomization & settings) {
+        for (const auto & entityCustomization : settings.entityCustomizations) {
+            if ((entityCustomization.product_id == product_id()) && (entityCustomization.device_id == device_id())) {
+                parse_customizations(entityCustomization.entity_ids, customizations_);
             }
+        }
+    });
+    customizations_loaded_ = true;
+}
 
-            // always write the mask
-            dv.state = ((dv.state & 0x0F) | (new_mask << 4)); // set state high bits to flag
+// the entities are registered, free the parsed customizations. They are parsed again when more entities are registered
+void EMSdevice::release_customizations() {
+    if (customizations_loaded_) {
+        std::vector<EntityCustom>().swap(customizations_);
+        customizations_loaded_ = false;
+    }
+}
 
-            // set the custom name if it has one, or clear it
-            if (has_custom_name) {
-                dv.custom_fullname = entity_id.substr(custom_name_pos + 1);
-            } else {
-                dv.custom_fullname = "";
-            }
+// set mask and custom name per device entity from a list of entity ids, in a single pass over the entities
+void EMSdevice::setCustomizationEntities(const std::vector<std::string> & entity_ids) {
+    std::vector<EntityCustom> customizations;
+    parse_customizations(entity_ids, customizations);
+    release_customizations(); // the settings are changing
 
-            auto min = dv.min;
-            auto max = dv.max;
+    if (customizations.empty()) {
+        return;
+    }
 
-            // set the min / max
-            dv.set_custom_minmax();
+    for (auto & dv : devicevalues_) {
+        char entity[70];
+        entity_name(entity, sizeof(entity), dv.tag, dv.short_name);
+        auto custom = find_customization(customizations, entity);
+        if (!custom) {
+            continue;
+        }
 
-            if (Mqtt::ha_enabled() && dv.short_name == FL_(seltemp)[0] && (min != dv.min || max != dv.max)) {
-                set_climate_minmax(dv.tag, dv.min, dv.max);
-            }
+        // check the masks
+        uint8_t current_mask = dv.state >> 4;
+        uint8_t new_mask     = custom->mask; // first character contains mask flags
 
-            return;
+        // if it's a new mask, reconfigure HA
+        if (Mqtt::ha_enabled() && (custom->has_custom_name || ((current_mask ^ new_mask) & (DeviceValueState::DV_READONLY >> 4)))) {
+            // remove ha config on change of dv_readonly flag
+            dv.remove_state(DeviceValueState::DV_HA_CONFIG_CREATED);
+            Mqtt::publish_ha_sensor_config_dv(dv, "", "", "", true); // delete topic (remove = true)
+        }
+
+        // always write the mask
+        dv.state = ((dv.state & 0x0F) | (new_mask << 4)); // set state high bits to flag
+
+        // set the custom name if it has one, or clear it
+        dv.custom_fullname = custom->has_custom_name ? custom->custom_fullname : "";
+
+        auto min = dv.min;
+        auto max = dv.max;
+
+        // set the min / max
+        dv.set_custom_minmax();
+
+        if (Mqtt::ha_enabled() && dv.short_name == FL_(seltemp)[0] && (min != dv.min || max != dv.max)) {
+            set_climate_minmax(dv.tag, dv.min, dv.max);
         }
     }
 }
 
 // populate a string vector with entities that have masks set or have a custom entity name
 void EMSdevice::getCustomizationEntities(std::vector<std::string> & entity_ids) {
+    // the names of the entities already in the list, sorted for the lookup
+    std::vector<std::string> listed;
+    listed.reserve(entity_ids.size());
+    for (const auto & eid : entity_ids) {
+        listed.push_back(DeviceValue::get_name(eid));
+    }
+    std::sort(listed.begin(), listed.end());
+
     for (const auto & dv : devicevalues_) {
+        uint8_t mask = dv.state >> 4;
+        if (!mask && dv.custom_fullname.empty()) {
+            continue;
+        }
+
         char name[100];
-        name[0] = '\0';
-        if (dv.tag >= DeviceValueTAG::TAG_HC1) {
-            // prefix tag
-            strcpy(name, tag_to_mqtt(dv.tag));
-            strcat(name, "/");
-        }
-        strcat(name, dv.short_name);
-        std::string entity_name = name;
-
-        uint8_t mask   = dv.state >> 4;
-        bool    is_set = false;
-        for (auto & eid : entity_ids) {
-            if (DeviceValue::get_name(eid) == entity_name) {
-                is_set = true;
-                break;
-            }
+        entity_name(name, sizeof(name), dv.tag, dv.short_name);
+        if (std::binary_search(listed.begin(), listed.end(), name)) {
+            continue;
         }
-        if (!is_set && (mask || !dv.custom_fullname.empty())) {
-            if (dv.custom_fullname.empty()) {
-                entity_ids.push_back(Helpers::hextoa(mask, false) + entity_name);
-            } else {
-                entity_ids.push_back(Helpers::hextoa(mask, false) + entity_name + "|" + dv.custom_fullname);
-            }
+
+        if (dv.custom_fullname.empty()) {
+            entity_ids.push_back(Helpers::hextoa(mask, false) + name);
+        } else {
+            entity_ids.push_back(Helpers::hextoa(mask, false) + name + "|" + dv.custom_fullname);
         }
     }
 }
@@ -1529,8 +1638,10 @@ bool EMSdevice::get_value_info(JsonObject output, const char * cmd, const int8_t
     char cmd_s[COMMAND_MAX_LENGTH];
     strlcpy(cmd_s, cmd, sizeof(cmd_s));
     const char * attribute_s = Command::get_attribute(cmd_s);
-    for (auto & dv : devicevalues_) {
-        if (cmd_s == Helpers::toLower(dv.short_name) && (tag <= 0 || tag == dv.tag)) {
+    auto         range       = dv_name_range(cmd_s);
+    for (auto it = range.first; it != range.second; ++it) {
+        auto & dv = devicevalues_[*it];
+        if (tag <= 0 || tag == dv.tag) {
             get_value_json(output, dv);
             // if we're filtering on an attribute, go find it
             // if we can't find it, maybe it exists but doesn't not have a value assigned yet
@@ -1863,9 +1974,11 @@ bool EMSdevice::generate_values(JsonObject output, const int8_t tag_filter, cons
 
 // create the Home Assistant configs for each device value / entity
 // this is called when an MQTT publish is done via an EMS Device in emsesp.cpp::publish_device_values()
+// and by the MQTT loop for the configs held back by the throttle
 void EMSdevice::mqtt_ha_entity_config_create() {
     bool     create_device_config = !ha_config_done(); // do we need to create the main Discovery device config with this entity?
     uint16_t count                = 0;
+    ha_config_pending_            = false;
 
     // check the state of each of the device values
     // create the discovery topic if if hasn't already been created, not a command (like reset) and is active and visible
@@ -1890,6 +2003,11 @@ void EMSdevice::mqtt_ha_entity_config_create() {
 
         if (!dv.has_state(DeviceValueState::DV_HA_CONFIG_CREATED) && dv.has_state(DeviceValueState::DV_ACTIVE)
             && !dv.has_state(DeviceValueState::DV_API_MQTT_EXCLUDE)) {
+            // pace the configs, the remaining ones are created from the MQTT loop
+            if (Mqtt::ha_throttled()) {
+                ha_config_pending_ = true;
+                break;
+            }
             // create_device_config is only done once for the EMS device. It can added to any entity, so we take the first
             if (Mqtt::publish_ha_sensor_config_dv(dv, name().c_str(), brand_to_char(), to_string_version().c_str(), false, create_device_config)) {
                 dv.add_state(DeviceValueState::DV_HA_CONFIG_CREATED);
@@ -1922,12 +2040,7 @@ void EMSdevice::ha_config_clear() {
 }
 
 bool EMSdevice::has_telegram_id(uint16_t id) const {
-    for (const auto & tf : telegram_functions_) {
-        if (tf.telegram_type_id_ == id) {
-            return true;
-        }
-    }
-    return false;
+    return telegram_index_.count(id) != 0;
 }
 
 // return the name of the telegram type
@@ -1939,9 +2052,10 @@ const char * EMSdevice::telegram_type_name(std::shared_ptr<const Telegram> teleg
         return "UBADevices";
     }
 
-    for (const auto & tf : telegram_functions_) {
-        if ((tf.telegram_type_id_ == telegram->type_id) && (telegram->type_id != 0xFF)) {
-            return tf.telegram_type_name_;
+    if (telegram->type_id != 0xFF) {
+        auto tf = find_telegram_function(telegram->type_id);
+        if (tf) {
+            return tf->telegram_type_name_;
         }
     }
 
@@ -1951,35 +2065,58 @@ const char * EMSdevice::telegram_type_name(std::shared_ptr<const Telegram> teleg
 // take a telegram_type_id and call the matching handler
 // return true if match found
 bool EMSdevice::handle_telegram(std::shared_ptr<const Telegram> telegram) {
-    for (auto & tf : telegram_functions_) {
-        if (tf.telegram_type_id_ == telegram->type_id) {
-            // for telegram destination only read telegram
-            if (telegram->dest == device_id_ && telegram->message_length > 0) {
-                tf.process_function_(telegram);
-                return true;
-            }
-            // if the data block is empty and we have not received data before, assume that this telegram
-            // is not recognized by the bus master. So remove it from the automatic fetch list
-            if (telegram->message_length == 0 && telegram->offset == 0 && !tf.received_) {
+    auto tf = find_telegram_function(telegram->type_id);
+    if (tf == nullptr) {
+        return false; // type not found
+    }
+
+    // for telegram destination only read telegram
+    if (telegram->dest == device_id_ && telegram->message_length > 0) {
+        tf->process_function_(telegram);
+        release_customizations(); // the handler may have registered entities
+        return true;
+    }
+    // if the data block is empty and we have not received data before, assume that this telegram
+    // is not recognized by the bus master. So remove it from the automatic fetch list
+    if (telegram->message_length == 0 && telegram->offset == 0 && !tf->received_) {
 #if defined(EMSESP_DEBUG)
-                EMSESP::logger().debug("This telegram (%s) is not recognized by the EMS bus", tf.telegram_type_name_);
+        EMSESP::logger().debug("This telegram (%s) is not recognized by the EMS bus", tf->telegram_type_name_);
 #endif
-                // removing fetch after start causes issue: https://github.com/emsesp/EMS-ESP32/issues/1420
-                // continue retry the first 5 minutes, then disable (added 15.3.2024)
-                if (uuid::get_uptime_sec() > 600) {
-                    tf.fetch_ = false;
+        // removing fetch after start causes issue: https://github.com/emsesp/EMS-ESP32/issues/1420
+        // continue retry the first 5 minutes, then disable (added 15.3.2024)
+        if (uuid::get_uptime_sec() > 600) {
+            tf->fetch_ = false;
+        }
+        return false;
+    }
+    if (telegram->message_length > 0) {
+        tf->received_ = true;
+        tf->process_function_(telegram);
+        release_customizations(); // the handler may have registered entities
+
+        // note when we got the data, a broadcast counts only if it is not cut off at the maximum length
+        // replies to our reads are continued with read_next_tx, so their first part is enough
+        if (telegram->offset == 0) {
+            uint32_t now = uuid::get_uptime();
+            if (telegram->dest == 0) {
+                if (telegram->message_length >= (telegram->type_id > 0xFF ? EMS_MAX_TELEGRAM_MESSAGE_LENGTH - 2 : EMS_MAX_TELEGRAM_MESSAGE_LENGTH)) {
+                    return true;
+                }
+                if (tf->broadcasts_) {
+                    uint32_t interval       = now - tf->last_broadcast_;
+                    tf->broadcast_interval_ = (tf->broadcasts_ > 1) ? (3 * tf->broadcast_interval_ + interval) / 4 : interval;
+                }
+                tf->last_broadcast_ = now;
+                if (tf->broadcasts_ < UINT8_MAX) {
+                    tf->broadcasts_++;
                 }
-                return false;
-            }
-            if (telegram->message_length > 0) {
-                tf.received_ = true;
-                tf.process_function_(telegram);
             }
-
-            return true;
+            tf->last_received_ = now;
+            tf->fresh_         = true;
         }
     }
-    return false; // type not found
+
+    return true;
 }
 
 // send Tx write with a data block
@@ -2019,13 +2156,12 @@ std::string EMSdevice::name() {
 // returns true on success.
 int EMSdevice::get_modbus_value(uint8_t tag, const std::string & shortname, std::vector<uint16_t> & result) {
     // find device value by shortname
-    // TODO replace linear search which is inefficient
-    const auto & it = std::find_if(devicevalues_.begin(), devicevalues_.end(), [&](const DeviceValue & x) { return x.tag == tag && x.short_name == shortname; });
-    if (it == devicevalues_.end() && (it->short_name != shortname || it->tag != tag)) {
+    auto dv_p = find_device_value(tag, shortname.c_str());
+    if (dv_p == nullptr) {
         return -1;
     }
 
-    auto & dv = *it;
+    auto & dv = *dv_p;
 
     // check if it exists, there is a value for the entity. Set the flag to ACTIVE
     // not that this will override any previously removed states
@@ -2107,12 +2243,12 @@ int EMSdevice::modbus_value_to_json(uint8_t tag, const std::string & shortname,
     // LOG_DEBUG("modbus_value_to_json(%d,%s,[%d bytes])\n", tag, shortname.c_str(), modbus_data.size());
 
     // find device value by shortname
-    const auto & it = std::find_if(devicevalues_.begin(), devicevalues_.end(), [&](const DeviceValue & x) { return x.tag == tag && x.short_name == shortname; });
-    if (it == devicevalues_.end() && (it->short_name != shortname || it->tag != tag)) {
+    auto dv_p = find_device_value(tag, shortname.c_str());
+    if (dv_p == nullptr) {
         return -1;
     }
 
-    auto & dv = *it;
+    auto & dv = *dv_p;
 
     // handle Booleans
     if (dv.type == DeviceValueType::BOOL) {
@@ -19,6 +19,8 @@
 #ifndef EMSESP_EMSDEVICE_H_
 #define EMSESP_EMSDEVICE_H_
 
+#include <unordered_map>
+
 #include "emsfactory.h"
 #include "telegram.h"
 #include "mqtt.h"
@@ -146,6 +148,21 @@ class EMSdevice {
         has_update_ = flag;
     }
 
+    // tags with values changed since the last MQTT publish, set via publish_value()
+    bool has_changed_tag(const int8_t tag) const {
+        return (tag >= 0) && (tag < 64) && (changed_tags_ & ((uint64_t)1 << tag));
+    }
+
+    void clear_changed_tags() {
+        changed_tags_  = 0;
+        changed_since_ = 0;
+    }
+
+    // reception time of the telegram with the oldest unpublished change, 0 if none
+    uint32_t changed_since() const {
+        return changed_since_;
+    }
+
     void has_update(void * value) {
         has_update_ = true;
         publish_value(value);
@@ -240,8 +257,9 @@ class EMSdevice {
 
     void set_climate_minmax(int8_t tag, int16_t min, uint32_t max);
     void setValueEnum(const void * value_p, const char * const ** options);
-    void setCustomizationEntity(const std::string & entity_id);
+    void setCustomizationEntities(const std::vector<std::string> & entity_ids);
     void getCustomizationEntities(std::vector<std::string> & entity_ids);
+    void release_customizations();
 
     void register_telegram_type(const uint16_t telegram_type_id, const char * telegram_type_name, bool fetch, const process_function_p cb);
     bool handle_telegram(std::shared_ptr<const Telegram> telegram);
@@ -337,11 +355,11 @@ class EMSdevice {
     bool         is_readonly(const std::string & cmd, const int8_t id) const;
     bool         has_command(const void * value_p) const;
     void         set_minmax(const void * value_p, int16_t min, uint32_t max);
-    void         publish_value(void * value_p) const;
+    void         publish_value(void * value_p);
     void         publish_all_values();
     void         mqtt_ha_entity_config_create();
     const char * telegram_type_name(std::shared_ptr<const Telegram> telegram);
-    void         fetch_values();
+    void         fetch_values(const bool only_stale = false);
     void         toggle_fetch(uint16_t telegram_id, bool toggle);
     bool         is_fetch(uint16_t telegram_id) const;
     bool         is_received(uint16_t telegram_id) const;
@@ -354,6 +372,9 @@ class EMSdevice {
     void ha_config_done(const bool v) {
         ha_config_done_ = v;
     }
+    bool ha_config_pending() const {
+        return ha_config_pending_;
+    }
 
     enum Brand : uint8_t {
         NO_BRAND = 0, // 0
@@ -402,6 +423,17 @@ class EMSdevice {
 
     static constexpr uint8_t EMS_DEVICES_MAX_TELEGRAMS = 20;
 
+    // scheduled fetches only request telegrams older than this, same as the fetch interval in EMSESP
+    static constexpr uint32_t FETCH_FRESHNESS = 60000;
+    static constexpr uint32_t FETCH_MARGIN    = 10000; // fetch a bit early, so data is not two intervals old
+
+    static uint32_t fetch_requests() {
+        return fetch_requests_;
+    }
+    static uint32_t fetch_skipped() {
+        return fetch_skipped_;
+    }
+
     // static device IDs
     static constexpr uint8_t EMS_DEVICE_ID_BOILER         = 0x08; // fixed device_id for Master Boiler/UBA
     static constexpr uint8_t EMS_DEVICE_ID_HS1            = 0x70; // fixed device_id for 1st. Cascade Boiler/UBA
@@ -527,8 +559,12 @@ class EMSdevice {
     uint8_t      brand_       = Brand::NO_BRAND;
     bool         active_      = true;
 
-    bool ha_config_done_ = false;
-    bool has_update_     = false;
+    bool ha_config_done_    = false;
+    bool ha_config_pending_ = false; // configs held back by the MQTT throttle
+    bool has_update_        = false;
+
+    uint64_t changed_tags_  = 0; // bitmask of DeviceValueTAGs with changed values, cleared when published
+    uint32_t changed_since_ = 0; // Latency::now() when the first of these changes was received
 
     struct TelegramFunction {
         const uint16_t           telegram_type_id_;   // it's type_id
@@ -536,6 +572,11 @@ class EMSdevice {
         bool                     fetch_;              // if this type_id be queried automatically
         bool                     received_;
         const process_function_p process_function_;
+        uint8_t                  broadcasts_         = 0; // # complete broadcasts seen, max 255
+        uint32_t                 last_received_      = 0; // uptime of the last complete data, valid when fresh_ is set
+        uint32_t                 last_broadcast_     = 0;
+        uint32_t                 broadcast_interval_ = 0; // ms, smoothed
+        bool                     fresh_              = false;
 
         TelegramFunction(uint16_t telegram_type_id, const char * telegram_type_name, bool fetch, bool received, const process_function_p process_function)
             : telegram_type_id_(telegram_type_id)
@@ -544,10 +585,58 @@ class EMSdevice {
             , received_(received)
             , process_function_(process_function) {
         }
+
+        // the freshness target is the broadcast interval if the device sends it often enough by itself, otherwise FETCH_FRESHNESS
+        bool stale(const uint32_t now) const {
+            if (!fresh_) {
+                return true;
+            }
+            uint32_t age = now - last_received_;
+            if (broadcasts_ > 1 && broadcast_interval_ <= FETCH_FRESHNESS) {
+                return age > broadcast_interval_ + broadcast_interval_ / 2; // a broadcast went missing
+            }
+            return age + FETCH_MARGIN >= FETCH_FRESHNESS;
+        }
     };
 
+    static uint32_t fetch_requests_; // # read requests from fetches
+    static uint32_t fetch_skipped_;  // # read requests saved because the data was fresh
+
     std::vector<uint16_t> handlers_ignored_;
 
+    // telegram_type_id -> index into telegram_functions_, so a telegram is resolved without scanning all handlers
+    std::unordered_map<uint16_t, uint16_t> telegram_index_;
+
+    const TelegramFunction * find_telegram_function(const uint16_t telegram_type_id) const;
+    TelegramFunction *       find_telegram_function(const uint16_t telegram_type_id);
+
+    // indexes into devicevalues_, kept sorted as entities are registered so lookups don't scan all entities
+    // entries with the same key stay in registration order, so the first match is the same as with a linear search
+    using dv_index_range = std::pair<std::vector<uint16_t>::const_iterator, std::vector<uint16_t>::const_iterator>;
+    std::vector<uint16_t> dv_name_index_;  // sorted by short_name (case insensitive)
+    std::vector<uint16_t> dv_value_index_; // sorted by value_p
+
+    void           index_device_value(const uint16_t dv_index);
+    dv_index_range dv_name_range(const char * short_name) const;
+    dv_index_range dv_value_range(const void * value_p) const;
+    DeviceValue *  find_device_value(const int8_t tag, const char * short_name);
+
+    // the customizations of this device parsed from the settings, sorted by entity name
+    // parsed when the first entity is registered and released when the registration is done
+    struct EntityCustom {
+        std::string name; // entity name with the tag prefix, e.g. hc1/seltemp
+        std::string custom_fullname;
+        uint8_t     mask;
+        bool        has_custom_name;
+    };
+    std::vector<EntityCustom> customizations_;
+    bool                      customizations_loaded_ = false;
+
+    void                        load_customizations();
+    static void                 entity_name(char * name, const size_t len, const int8_t tag, const char * short_name);
+    static void                 parse_customizations(const std::vector<std::string> & entity_ids, std::vector<EntityCustom> & customizations);
+    static const EntityCustom * find_customization(const std::vector<EntityCustom> & customizations, const char * name);
+
 #if defined(EMSESP_STANDALONE) || defined(EMSESP_TEST)
   public: // so we can call it from WebCustomizationService::test() and EMSESP::dump_all_entities()
 #endif
@@ -31,6 +31,7 @@ namespace emsesp {
 // Static member definitions
 std::deque<std::unique_ptr<EMSdevice>> EMSESP::emsdevices;
 std::vector<EMSESP::Device_record>     EMSESP::device_library_;
+std::array<EMSdevice *, 128>           EMSESP::device_dispatch_{};
 uuid::log::Logger                      EMSESP::logger_{F_(emsesp), uuid::log::Facility::KERN};
 uint16_t                               EMSESP::watch_id_         = WATCH_ID_NONE;
 uint8_t                                EMSESP::watch_            = 0;
@@ -43,8 +44,11 @@ uint8_t                                EMSESP::publish_all_idx_  = 0;
 uint8_t                                EMSESP::unique_id_count_  = 0;
 bool                                   EMSESP::trace_raw_        = false;
 uint16_t                               EMSESP::wait_validate_    = 0;
+uint32_t                               EMSESP::validate_since_   = 0;
 bool                                   EMSESP::wait_km_          = false;
 uint32_t                               EMSESP::last_fetch_       = 0;
+std::mutex                             EMSESP::validate_mutex_;
+std::vector<std::function<void()>>     EMSESP::validate_callbacks_;
 
 AsyncWebServer webServer(80);
 
@@ -149,6 +153,19 @@ void EMSESP::clear_all_devices() {
     // emsdevices.clear(); // remove entries, but doesn't delete actual devices
 }
 
+// rebuild the device_id lookup used by process_telegram()
+// called whenever a device is added or removed, or the order of emsdevices changes
+// if more devices share the same device_id the first one in emsdevices is used
+void EMSESP::rebuild_device_dispatch() {
+    device_dispatch_.fill(nullptr);
+    for (const auto & emsdevice : emsdevices) {
+        auto & entry = device_dispatch_[emsdevice->device_id() & 0x7F];
+        if (entry == nullptr) {
+            entry = emsdevice.get();
+        }
+    }
+}
+
 // return number of devices of a known type
 uint8_t EMSESP::count_devices(const uint8_t device_type) {
     uint8_t count = 0;
@@ -288,7 +305,24 @@ void EMSESP::show_ems(uuid::console::Shell & shell) {
         shell.printfln("  #read fails (after %d retries): %d", TxService::MAXIMUM_TX_RETRIES, txservice_.telegram_read_fail_count());
         shell.printfln("  #write fails (after %d retries): %d", TxService::MAXIMUM_TX_RETRIES, txservice_.telegram_write_fail_count());
         shell.printfln("  Rx line quality: %d%%", rxservice_.quality());
+        shell.printfln("  Rx ring: max %d of %d frames, %d overflows, max latency %d ms",
+                       rxservice_.ring().high_water(),
+                       RxFrameRing::SIZE,
+                       rxservice_.ring().overflow_count(),
+                       rxservice_.ring_latency_max());
         shell.printfln("  Tx line quality: %d%%", (txservice_.read_quality() + txservice_.read_quality()) / 2);
+        static const char * const lanes[] = {"writes", "validation reads", "fetches"};
+        for (uint8_t lane = 0; lane < TxService::TX_LANES; lane++) {
+            const auto & stats = txservice_.lane_stats(lane);
+            shell.printfln("  Tx %s: %d queued, %d sent, wait avg %d ms, max %d ms",
+                           lanes[lane],
+                           txservice_.lane_depth(lane),
+                           stats.sent,
+                           stats.sent ? (uint32_t)(stats.wait_total / stats.sent) : 0,
+                           stats.wait_max);
+        }
+        shell.printfln("  Tx merged into pending telegrams: %d", txservice_.merged_count());
+        shell.printfln("  Fetch read requests: %d sent, %d saved (recently received or broadcasted)", EMSdevice::fetch_requests(), EMSdevice::fetch_skipped());
         shell.println();
     }
 
@@ -558,6 +592,7 @@ void EMSESP::show_sensor_values(uuid::console::Shell & shell) {
 void EMSESP::publish_all(bool force) {
     if (force) {
         publish_all_idx_ = 1;
+        Mqtt::ha_fingerprints_clear(); // send all HA configs, also the unchanged ones
         reset_mqtt_ha();
         return;
     }
@@ -639,17 +674,52 @@ void EMSESP::reset_mqtt_ha() {
     webCustomEntityService.ha_reset();
 }
 
+// create the HA configs the devices held back because of the MQTT throttle
+void EMSESP::create_ha_configs() {
+    for (const auto & emsdevice : emsdevices) {
+        if (emsdevice && emsdevice->ha_config_pending()) {
+            emsdevice->mqtt_ha_entity_config_create();
+        }
+    }
+}
+
 // create json doc for the devices values and add to MQTT publish queue
 // this will also create the HA /config topic for each device value
 // generate_values_json is called to build the device value (dv) object array
-void EMSESP::publish_device_values(uint8_t device_type) {
+// publish the values of all devices of a device type
+// with only_changed set (on-change publishing), tags without a changed value are skipped. This only works on the
+// individual tag topics, in nested mode all tags share one topic and the full payload is always sent
+void EMSESP::publish_device_values(uint8_t device_type, const bool only_changed) {
     JsonDocument doc;
     JsonObject   json         = doc.to<JsonObject>();
     bool         need_publish = false;
     bool         nested       = (Mqtt::is_nested());
 
+    // measure the publishes against the oldest change they carry
+    uint32_t received = Latency::received();
+    for (const auto & emsdevice : emsdevices) {
+        if (emsdevice && (emsdevice->device_type() == device_type) && emsdevice->changed_since()
+            && (!received || (int32_t)(emsdevice->changed_since() - received) < 0)) {
+            received = emsdevice->changed_since();
+        }
+    }
+    uint32_t processing = Latency::received();
+    Latency::telegram(received);
+
     // group by device type
     for (int8_t tag = DeviceValueTAG::TAG_DEVICE_DATA; tag <= DeviceValueTAG::TAG_HS16; tag++) {
+        if (only_changed && !nested) {
+            bool changed = false;
+            for (const auto & emsdevice : emsdevices) {
+                if (emsdevice && (emsdevice->device_type() == device_type) && emsdevice->has_changed_tag(tag)) {
+                    changed = true;
+                    break;
+                }
+            }
+            if (!changed) {
+                continue;
+            }
+        }
         JsonObject json_tag     = json;
         bool       nest_created = false;
         for (const auto & emsdevice : emsdevices) {
@@ -675,6 +745,13 @@ void EMSESP::publish_device_values(uint8_t device_type) {
         Mqtt::queue_publish(Mqtt::tag_to_topic(device_type, DeviceValueTAG::TAG_NONE), json);
     }
 
+    for (const auto & emsdevice : emsdevices) {
+        if (emsdevice && (emsdevice->device_type() == device_type)) {
+            emsdevice->clear_changed_tags();
+        }
+    }
+    Latency::telegram(processing);
+
     // we want to create the /config topic after the data payload to prevent HA from throwing up a warning
     if (Mqtt::ha_enabled()) {
         for (const auto & emsdevice : emsdevices) {
@@ -1112,56 +1189,51 @@ bool EMSESP::process_telegram(std::shared_ptr<const Telegram> telegram) {
     // calls the associated process function for that EMS device
     // returns false if the device_id doesn't recognize it
     // after the telegram has been processed, see if there have been values changed and we need to do a MQTT publish
-    bool    telegram_found = false;
-    uint8_t device_found   = 0;
+    bool        telegram_found = false;
+    EMSdevice * emsdevice      = nullptr;
     // broadcast or send to us
-    for (const auto & emsdevice : emsdevices) {
-        if (emsdevice->is_device_id(telegram->src) && (telegram->dest == 0 || telegram->dest == EMSbus::ems_bus_id())) {
+    if (telegram->dest == 0 || telegram->dest == EMSbus::ems_bus_id()) {
+        emsdevice = device_dispatch(telegram->src);
+        if (emsdevice) {
             telegram_found = emsdevice->handle_telegram(telegram);
-            device_found   = emsdevice->unique_id();
-            break;
         }
     }
-    if (!telegram_found) {
+    if (!telegram_found && telegram->src != EMSbus::ems_bus_id()) {
         // check for command to the device
-        for (const auto & emsdevice : emsdevices) {
-            if (emsdevice->is_device_id(telegram->dest) && telegram->src != EMSbus::ems_bus_id()) {
-                telegram_found = emsdevice->handle_telegram(telegram);
-                device_found   = emsdevice->unique_id();
-                break;
-            }
+        auto dest_device = device_dispatch(telegram->dest);
+        if (dest_device) {
+            emsdevice      = dest_device;
+            telegram_found = emsdevice->handle_telegram(telegram);
         }
     }
-    if (!telegram_found) {
+    if (!telegram_found && telegram->dest == 0x10) {
         // check for sends to master thermostat
-        for (const auto & emsdevice : emsdevices) {
-            if (emsdevice->is_device_id(telegram->src) && telegram->dest == 0x10) {
-                telegram_found = emsdevice->handle_telegram(telegram);
-                device_found   = emsdevice->unique_id();
-                break;
-            }
+        auto src_device = device_dispatch(telegram->src);
+        if (src_device) {
+            emsdevice      = src_device;
+            telegram_found = emsdevice->handle_telegram(telegram);
         }
     }
-    for (const auto & emsdevice : emsdevices) {
-        if (emsdevice->unique_id() == device_found) {
-            if (!telegram_found && telegram->message_length > 0) {
-                emsdevice->add_handlers_ignored(telegram->type_id);
-            }
-            if (wait_validate_ == telegram->type_id) {
-                wait_validate_ = 0;
+    if (emsdevice) {
+        if (!telegram_found && telegram->message_length > 0) {
+            emsdevice->add_handlers_ignored(telegram->type_id);
+        }
+        if (wait_validate_ == telegram->type_id) {
+            validate_done();
+        }
+        if (Mqtt::connected() && telegram_found
+            && ((mqtt_.get_publish_onchange(emsdevice->device_type()) && emsdevice->has_update())
+                || (telegram->type_id == publish_id_ && telegram->dest == EMSbus::ems_bus_id()))) {
+            // an explicit publish request sends the full payload, on-change only the tags with changed values
+            bool only_changed = true;
+            if (telegram->type_id == publish_id_) {
+                publish_id_  = 0;
+                only_changed = false;
             }
-            if (Mqtt::connected() && telegram_found
-                && ((mqtt_.get_publish_onchange(emsdevice->device_type()) && emsdevice->has_update())
-                    || (telegram->type_id == publish_id_ && telegram->dest == EMSbus::ems_bus_id()))) {
-                if (telegram->type_id == publish_id_) {
-                    publish_id_ = 0;
-                }
-                emsdevice->has_update(false); // reset flag
-                if (!Mqtt::publish_single()) {
-                    publish_device_values(emsdevice->device_type()); // publish to MQTT if we explicitly have too
-                }
+            emsdevice->has_update(false); // reset flag
+            if (!Mqtt::publish_single()) {
+                publish_device_values(emsdevice->device_type(), only_changed); // publish to MQTT if we explicitly have too
             }
-            break;
         }
     }
     // handle unknown broadcasted telegrams (or send to us)
@@ -1170,7 +1242,7 @@ bool EMSESP::process_telegram(std::shared_ptr<const Telegram> telegram) {
         if (watch() == WATCH_UNKNOWN) {
             LOG_NOTICE("%s", pretty_telegram(telegram).c_str());
         }
-        if (!wait_km_ && !device_found && (telegram->src != EMSbus::ems_bus_id()) && (telegram->message_length > 0)) {
+        if (!wait_km_ && !emsdevice && (telegram->src != EMSbus::ems_bus_id()) && (telegram->message_length > 0)) {
             send_read_request(EMSdevice::EMS_TYPE_VERSION, telegram->src);
         }
     }
@@ -1254,6 +1326,7 @@ bool EMSESP::add_device(const uint8_t device_id, const uint8_t product_id, const
                 return true;
             }
             emsdevices.erase(it); // erase the old device without product_id and re detect
+            rebuild_device_dispatch();
             break;
         }
         it++;
@@ -1289,6 +1362,7 @@ bool EMSESP::add_device(const uint8_t device_id, const uint8_t product_id, const
         LOG_NOTICE("Unrecognized EMS device (deviceID 0x%02X, productID %d). Please report on GitHub.", device_id, product_id);
         emsdevices.push_back(
             EMSFactory::add(DeviceType::GENERIC, device_id, product_id, version, "unknown", DeviceFlags::EMS_DEVICE_FLAG_NONE, EMSdevice::Brand::NO_BRAND));
+        rebuild_device_dispatch();
         return false; // not found
     }
 
@@ -1383,6 +1457,7 @@ bool EMSESP::add_device(const uint8_t device_id, const uint8_t product_id, const
 
     LOG_DEBUG("Adding new device %s (deviceID 0x%02X, productID %d, version %s)", default_name, device_id, product_id, version);
     emsdevices.push_back(EMSFactory::add(device_type, device_id, product_id, version, default_name, flags, brand));
+    emsdevices.back()->release_customizations(); // the entities are registered
 
     // see if we have a custom device name in our Customizations list, and if so set it
     webCustomizationService.read([&](WebCustomization const & settings) {
@@ -1403,6 +1478,7 @@ bool EMSESP::add_device(const uint8_t device_id, const uint8_t product_id, const
     std::sort(emsdevices.begin(), emsdevices.end(), [](const std::unique_ptr<EMSdevice> & a, const std::unique_ptr<EMSdevice> & b) {
         return a->device_type() < b->device_type();
     });
+    rebuild_device_dispatch();
 
     fetch_device_values(device_id); // go and fetch its device entity data
 
@@ -1450,6 +1526,7 @@ void EMSESP::send_write_request(const uint16_t type_id, const uint8_t dest, cons
 
 // this is main entry point when data is received on the Rx line, via emsuart library
 // we check if its a complete telegram or just a single byte (which could be a poll or a return status)
+// runs in the UART task: polls and Tx replies are handled here, telegrams are passed to the main loop via the Rx ring
 // the CRC check is not done here, only when it's added to the Rx queue with add()
 void EMSESP::incoming_telegram(uint8_t * data, const uint8_t length) {
 #ifdef EMSESP_UART_DEBUG
@@ -1465,7 +1542,7 @@ void EMSESP::incoming_telegram(uint8_t * data, const uint8_t length) {
         LOG_TRACE("[UART_DEBUG] Echo after %d ms: %s", ::millis() - rx_time_, Helpers::data_to_hex(data, length).c_str());
 #endif
         // add to RxQueue for log/watch
-        rxservice_.add(data, length);
+        rxservice_.receive(data, length);
         return; // it's an echo
     }
 
@@ -1478,6 +1555,7 @@ void EMSESP::incoming_telegram(uint8_t * data, const uint8_t length) {
         // if we're waiting on a Write operation, we want a single byte 1 or 4
         if ((tx_state == Telegram::Operation::TX_WRITE) && (length == 1)) {
             if (first_value == TxService::TX_WRITE_SUCCESS) {
+                Latency::tx_replied(true);
                 LOG_DEBUG("Last Tx write successful");
                 txservice_.increment_telegram_write_count(); // last tx/write was confirmed ok
                 txservice_.send_poll();                      // close the bus
@@ -1485,6 +1563,7 @@ void EMSESP::incoming_telegram(uint8_t * data, const uint8_t length) {
                 txservice_.reset_retry_count();
                 tx_successful = true;
             } else if (first_value == TxService::TX_WRITE_FAIL) {
+                Latency::tx_replied(true);
                 LOG_ERROR("Last Tx write rejected by host");
                 txservice_.send_poll(); // close the bus
                 txservice_.reset_retry_count();
@@ -1497,6 +1576,7 @@ void EMSESP::incoming_telegram(uint8_t * data, const uint8_t length) {
             uint8_t src  = data[0];
             uint8_t dest = data[1];
             if (txservice_.is_last_tx(src, dest)) {
+                Latency::tx_replied(false);
                 LOG_DEBUG("Last Tx read successful");
                 txservice_.increment_telegram_read_count();
                 txservice_.reset_retry_count();
@@ -1566,7 +1646,7 @@ void EMSESP::incoming_telegram(uint8_t * data, const uint8_t length) {
 #endif
         Roomctrl::check(data[1], data, length); // check if there is a message for the roomcontroller
 
-        rxservice_.add(data, length); // add to RxQueue
+        rxservice_.receive(data, length); // hand over to the main loop
     }
 }
 
@@ -1583,7 +1663,7 @@ void EMSESP::scheduled_fetch_values() {
             uint8_t i = 0;
             for (const auto & emsdevice : emsdevices) {
                 if (++i >= no) {
-                    emsdevice->fetch_values();
+                    emsdevice->fetch_values(true);
                     no++;
                     return;
                 }
@@ -1594,6 +1674,54 @@ void EMSESP::scheduled_fetch_values() {
     }
 }
 
+// set the type_id of a write we're waiting to read back, 0 if there is nothing to wait for
+void EMSESP::wait_validate(uint16_t wait) {
+    if (!wait) {
+        validate_done();
+        return;
+    }
+    std::lock_guard<std::mutex> lock(validate_mutex_);
+    wait_validate_ = wait;
+}
+
+// register a callback for when the pending validation is done or timed out
+// returns false if there is nothing to wait for (anymore), the callback is not called then
+bool EMSESP::on_validate(std::function<void()> callback) {
+    std::lock_guard<std::mutex> lock(validate_mutex_);
+    if (!wait_validate_) {
+        return false;
+    }
+    if (validate_callbacks_.empty()) {
+        validate_since_ = uuid::get_uptime();
+    }
+    validate_callbacks_.push_back(std::move(callback));
+    return true;
+}
+
+void EMSESP::validate_done() {
+    std::vector<std::function<void()>> callbacks;
+    {
+        std::lock_guard<std::mutex> lock(validate_mutex_);
+        wait_validate_ = 0;
+        callbacks.swap(validate_callbacks_);
+    }
+    for (const auto & callback : callbacks) {
+        callback();
+    }
+}
+
+// give up waiting after the post send delay plus the time for the read
+void EMSESP::validate_loop() {
+    {
+        std::lock_guard<std::mutex> lock(validate_mutex_);
+        if (validate_callbacks_.empty() || (uuid::get_uptime() - validate_since_ <= TxService::POST_SEND_DELAY + 500)) {
+            return;
+        }
+        LOG_DEBUG("Timeout waiting for validation of 0x%02X", wait_validate_);
+    }
+    validate_done();
+}
+
 // EMSESP main class
 
 EMSESP::EMSESP()
@@ -1743,23 +1871,40 @@ void EMSESP::shell_prompt() {
 
 // main loop calling all services
 void EMSESP::loop() {
+    uint32_t loop_start = Profiler::start();
+    uint32_t t          = loop_start;
+
     esp32React.loop(); // web services
-    system_.loop();    // does LED and checks system health, and syslog service
+    t = Profiler::lap(Profiler::WEB, t);
+    system_.loop(); // does LED and checks system health, and syslog service
+    t = Profiler::lap(Profiler::SYSTEM, t);
 
     // run the loop, unless we're in the middle of an OTA upload
     if (EMSESP::system_.systemStatus() == SYSTEM_STATUS::SYSTEM_STATUS_NORMAL) {
-        webLogService.loop();       // log in Web UI
-        rxservice_.loop();          // process any incoming Rx telegrams
-        shower_.loop();             // check for shower on/off
-        temperaturesensor_.loop();  // read sensor temperatures
-        analogsensor_.loop();       // read analog sensor values
-        publish_all_loop();         // with HA messages in parts to avoid flooding the MQTT queue
-        mqtt_.loop();               // sends out anything in the MQTT queue
-        webModulesService.loop();   // loop through the external library modules
+        webLogService.loop(); // log in Web UI
+        t = Profiler::lap(Profiler::WEBLOG, t);
+        rxservice_.loop(); // process any incoming Rx telegrams
+        t = Profiler::lap(Profiler::RX, t);
+        shower_.loop(); // check for shower on/off
+        t = Profiler::lap(Profiler::SHOWER, t);
+        temperaturesensor_.loop(); // read sensor temperatures
+        t = Profiler::lap(Profiler::TEMPERATURESENSOR, t);
+        analogsensor_.loop(); // read analog sensor values
+        t = Profiler::lap(Profiler::ANALOGSENSOR, t);
+        publish_all_loop(); // with HA messages in parts to avoid flooding the MQTT queue
+        t = Profiler::lap(Profiler::PUBLISH, t);
+        mqtt_.loop(); // sends out anything in the MQTT queue
+        t = Profiler::lap(Profiler::MQTT, t);
+        webModulesService.loop(); // loop through the external library modules
+        t = Profiler::lap(Profiler::MODULES, t);
         if (system_.PSram() == 0) { // run non-async if there is no PSRAM available
             webSchedulerService.loop();
+            t = Profiler::lap(Profiler::SCHEDULER, t);
         }
         scheduled_fetch_values(); // force a query on the EMS devices to fetch latest data at a set interval (1 min)
+        t = Profiler::lap(Profiler::FETCH, t);
+        validate_loop(); // answer web requests waiting for a write to be read back
+        t = Profiler::lap(Profiler::VALIDATE, t);
     }
 
     if (EMSESP::system_.systemStatus() == SYSTEM_STATUS::SYSTEM_STATUS_PENDING_UPLOAD) {
@@ -1809,6 +1954,9 @@ void EMSESP::loop() {
             start_serial_console();
         }
     }
+
+    Profiler::lap(Profiler::SHELL, t);
+    Profiler::lap(Profiler::LOOP, loop_start);
 }
 
 } // namespace emsesp
@@ -26,6 +26,8 @@
 #include <deque>
 #include <unordered_map>
 #include <list>
+#include <array>
+#include <mutex>
 
 #include <ArduinoJson.h>
 
@@ -70,6 +72,7 @@
 #include "shower.h"
 #include "roomcontrol.h"
 #include "command.h"
+#include "profiler.h"
 
 #include "../emsesp_version.h"
 
@@ -104,11 +107,12 @@ class EMSESP {
 
     static uuid::log::Logger logger();
 
-    static void publish_device_values(uint8_t device_type);
+    static void publish_device_values(uint8_t device_type, const bool only_changed = false);
     static void publish_other_values();
     static void publish_sensor_values(const bool time, const bool force = false);
     static void publish_all(bool force = false);
     static void reset_mqtt_ha();
+    static void create_ha_configs();
 
 #ifdef EMSESP_STANDALONE
     static void run_test(uuid::console::Shell & shell, const std::string & command); // only for testing
@@ -139,6 +143,11 @@ class EMSESP {
     static uint8_t device_index(const uint8_t device_type, const uint8_t unique_id);
     static bool    get_device_value_info(JsonObject root, const char * cmd, const int8_t id, const uint8_t devicetype);
 
+    // returns the device handling telegrams for this device_id, or nullptr
+    static EMSdevice * device_dispatch(const uint8_t device_id) {
+        return device_dispatch_[device_id & 0x7F];
+    }
+
     static void show_device_values(uuid::console::Shell & shell);
     static void show_sensor_values(uuid::console::Shell & shell);
     static void show_devices(uuid::console::Shell & shell);
@@ -190,9 +199,9 @@ class EMSESP {
     static bool wait_validate() {
         return (wait_validate_ != 0);
     }
-    static void wait_validate(uint16_t wait) {
-        wait_validate_ = wait;
-    }
+    static void wait_validate(uint16_t wait);
+    static bool on_validate(std::function<void()> callback);
+    static void validate_loop();
 
     enum Bus_status : uint8_t { BUS_STATUS_CONNECTED = 0, BUS_STATUS_TX_ERRORS, BUS_STATUS_OFFLINE };
     static uint8_t bus_status();
@@ -255,6 +264,8 @@ class EMSESP {
     static void        process_version(std::shared_ptr<const Telegram> telegram);
     static void        publish_response(std::shared_ptr<const Telegram> telegram);
     static void        publish_all_loop();
+    static void        rebuild_device_dispatch();
+    static void        validate_done();
 
     void shell_prompt();
     void start_serial_console();
@@ -270,6 +281,9 @@ class EMSESP {
     };
     static std::vector<Device_record> device_library_;
 
+    // lookup table from a 7-bit EMS device_id to the device object handling its telegrams, rebuilt when emsdevices changes
+    static std::array<EMSdevice *, 128> device_dispatch_;
+
     static uint16_t watch_id_;
     static uint8_t  watch_;
     static uint16_t read_id_;
@@ -281,9 +295,13 @@ class EMSESP {
     static uint8_t  unique_id_count_;
     static bool     trace_raw_;
     static uint16_t wait_validate_;
+    static uint32_t validate_since_;
     static bool     wait_km_;
     static uint32_t last_fetch_;
 
+    static std::mutex                         validate_mutex_;     // callbacks are added from the web server task
+    static std::vector<std::function<void()>> validate_callbacks_; // run when the validation is done or timed out
+
     // UUID stuff
     static constexpr auto &        serial_console_          = Serial;
     static constexpr unsigned long SERIAL_CONSOLE_BAUD_RATE = 115200;
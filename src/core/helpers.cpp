@@ -691,6 +691,15 @@ std::string Helpers::toLower(const char * s) {
     return toLower(std::string(s));
 }
 
+// 32 bit FNV-1a hash of a string
+uint32_t Helpers::hash(const char * s) {
+    uint32_t hash = 2166136261u;
+    while (*s) {
+        hash = (hash ^ (uint8_t)*s++) * 16777619u;
+    }
+    return hash;
+}
+
 std::string Helpers::toUpper(std::string const & s) {
     std::string lc = s;
     std::transform(lc.begin(), lc.end(), lc.begin(), [](unsigned char c) { return std::toupper(c); });
@@ -787,20 +796,14 @@ uint8_t Helpers::count_items(const char * const ** list) {
 
 // returns char pointer to translated description or fullname
 // if force_en is true always take the EN non-translated word
+// the lists have a slot for every language, so the word is at the language index. Empty or nullptr if not translated, then revert to EN
 const char * Helpers::translated_word(const char * const * strings, const bool force_en) {
-    uint8_t language_index = EMSESP::system_.language_index();
-    uint8_t index          = 0; // default en
-
     if (!strings) {
         return ""; // no translations
     }
 
-    // see how many translations we have for this entity. if there is no translation for this, revert to EN
-    if (!force_en && (Helpers::count_items(strings) >= language_index + 1 && strlen(strings[language_index]))) {
-        index = language_index;
-    }
-
-    return strings[index];
+    const char * word = force_en ? nullptr : strings[EMSESP::system_.language_index()];
+    return (word && *word) ? word : strings[0];
 }
 
 uint16_t Helpers::string2minutes(const std::string & str) {
@@ -56,6 +56,7 @@ class Helpers {
     static std::string toLower(std::string const & s);
     static std::string toUpper(std::string const & s);
     static std::string toLower(const char * s);
+    static uint32_t    hash(const char * s); // FNV-1a
     static void        CharToUpperUTF8(char * c);
 
     static void replace_char(char * str, char find, char replace);
@@ -55,6 +55,8 @@ MAKE_WORD(ems)
 MAKE_WORD(devices)
 MAKE_WORD(shower)
 MAKE_WORD(mqtt)
+MAKE_WORD(perf)
+MAKE_WORD(latency)
 MAKE_WORD(modbus)
 MAKE_WORD(emsesp)
 MAKE_WORD(connected)
@@ -157,7 +159,7 @@ MAKE_WORD_CUSTOM(deviceid_mandatory, "<deviceID>")
 MAKE_WORD_CUSTOM(device_type_optional, "[device]")
 MAKE_WORD_CUSTOM(invalid_log_level, "Invalid log level")
 MAKE_WORD_CUSTOM(log_level_optional, "[level]")
-MAKE_WORD_CUSTOM(show_commands, "[system | users | devices | log | ems | values | mqtt | commands]")
+MAKE_WORD_CUSTOM(show_commands, "[system | users | devices | log | ems | values | mqtt | perf | latency | commands]")
 MAKE_WORD_CUSTOM(name_mandatory, "<name>")
 MAKE_WORD_CUSTOM(name_optional, "[name]")
 MAKE_WORD_CUSTOM(new_password_prompt1, "Enter new password: ")
@@ -250,6 +250,24 @@ ModbusMessage Modbus::handleSystemRead(const ModbusMessage & request) {
     return response;
 }
 
+// read the registers of a single entity from the first device of this type that has a value for it
+// returns 0 on success, otherwise the error code from get_modbus_value()
+int Modbus::readEntity(const uint8_t device_type, const uint8_t tag, const EntityModbusInfo & modbusInfo, std::vector<uint16_t> & buf) {
+    int error_code = -1;
+    for (const auto & emsdevice : EMSESP::emsdevices) {
+        if (emsdevice->device_type() == device_type) {
+            error_code = emsdevice->get_modbus_value(tag, modbusInfo.short_name, buf);
+            if (!error_code) {
+                break;
+            }
+        }
+    }
+    return error_code;
+}
+
+// reads either a single entity, or a block of consecutive registers within the same tag block
+// in a block, registers not mapped to an entity and entities without a value are filled with REGISTER_NO_VALUE
+// a block must start and end on entity boundaries, partial entities can not be read
 ModbusMessage Modbus::handleRead(const ModbusMessage & request) {
     ModbusMessage response;
 
@@ -262,6 +280,12 @@ ModbusMessage Modbus::handleRead(const ModbusMessage & request) {
 
     LOG_DEBUG("Got read request for serverId %d, startAddress %d, numWords %d", device_type, start_address, num_words);
 
+    if (num_words == 0 || num_words > MAX_READ_REGISTERS) {
+        LOG_ERROR("number of registers requested (%d) is out of range", num_words);
+        response.setError(request.getServerID(), request.getFunctionCode(), ILLEGAL_DATA_VALUE);
+        return response;
+    }
+
     // each register block corresponds to a device value tag
     auto tag      = (uint8_t)(start_address / REGISTER_BLOCK_SIZE);
     auto tag_type = tag_to_type(tag);
@@ -274,6 +298,11 @@ ModbusMessage Modbus::handleRead(const ModbusMessage & request) {
     }
 
     auto register_offset = start_address - tag * REGISTER_BLOCK_SIZE;
+    if (register_offset + num_words > REGISTER_BLOCK_SIZE) {
+        LOG_ERROR("registers requested are crossing the register block of the tag");
+        response.setError(request.getServerID(), request.getFunctionCode(), ILLEGAL_DATA_ADDRESS);
+        return response;
+    }
 
     // binary search in modbus infos
     auto key = EntityModbusInfoKey(device_type, tag_type, register_offset);
@@ -283,37 +312,59 @@ ModbusMessage Modbus::handleRead(const ModbusMessage & request) {
                                                key,
                                                [](const EntityModbusInfo & a, const EntityModbusInfoKey & b) { return a.isLessThan(b); });
 
+    // a single entity, return an error if it can't be read
+    if (modbusInfo != std::end(modbus_register_mappings) && modbusInfo->equals(key) && num_words == modbusInfo->registerCount) {
+        auto buf        = std::vector<uint16_t>(num_words);
+        int  error_code = readEntity(device_type, tag, *modbusInfo, buf);
+        if (error_code) {
+            if (uuid::get_uptime_sec() > 60 || error_code < -2) { // suppress not found messages for the first minute
+                LOG_ERROR("Unable to read raw device value %s for tag=%d - error_code = %d", modbusInfo->short_name, (int)tag, error_code);
+            }
+            response.setError(request.getServerID(), request.getFunctionCode(), SERVER_DEVICE_FAILURE);
+            return response;
+        }
 
-    if (modbusInfo == std::end(modbus_register_mappings) || !modbusInfo->equals(key)) {
-        // combination of device_type/tag_type/register_offset does not exist
-        LOG_ERROR("combination of device_type/tag_type/register_offset does not exist");
-        response.setError(request.getServerID(), request.getFunctionCode(), ILLEGAL_DATA_ADDRESS);
-        return response;
-    }
+        response.add(request.getServerID());
+        response.add(request.getFunctionCode());
+        response.add((uint8_t)(num_words * 2));
+        for (auto & value : buf)
+            response.add(value);
 
-    // only reading a single value at a time is supported for now
-    if (num_words != modbusInfo->registerCount) {
-        // number of registers requested does not match actual register count for entity
-        LOG_ERROR("number of registers requested does not match actual register count for entity");
-        response.setError(request.getServerID(), request.getFunctionCode(), ILLEGAL_DATA_ADDRESS);
         return response;
     }
 
-    auto buf        = std::vector<uint16_t>(num_words);
-    int  error_code = -1;
-    for (const auto & emsdevice : EMSESP::emsdevices) {
-        if (emsdevice->device_type() == device_type) {
-            error_code = emsdevice->get_modbus_value(tag, modbusInfo->short_name, buf);
-            if (!error_code) {
-                break;
-            }
+    // a block of registers. The start must not be in the middle of the previous entity
+    if (modbusInfo != std::begin(modbus_register_mappings)) {
+        auto prev = std::prev(modbusInfo);
+        if (prev->device_type == device_type && prev->device_value_tag_type == tag_type && prev->registerOffset + prev->registerCount > register_offset) {
+            LOG_ERROR("start address %d is not the start of an entity", start_address);
+            response.setError(request.getServerID(), request.getFunctionCode(), ILLEGAL_DATA_ADDRESS);
+            return response;
         }
     }
-    if (error_code) {
-        if (uuid::get_uptime_sec() > 60 || error_code < -2) { // suppress not found messages for the first minute
-            LOG_ERROR("Unable to read raw device value %s for tag=%d - error_code = %d", modbusInfo->short_name, (int)tag, error_code);
+
+    auto    buf      = std::vector<uint16_t>(num_words, REGISTER_NO_VALUE);
+    uint8_t entities = 0;
+    for (auto mi = modbusInfo; mi != std::end(modbus_register_mappings); mi++) {
+        if (mi->device_type != device_type || mi->device_value_tag_type != tag_type || mi->registerOffset >= register_offset + num_words) {
+            break;
+        }
+        if (mi->registerOffset + mi->registerCount > register_offset + num_words) {
+            LOG_ERROR("number of registers requested ends in the middle of entity %s", mi->short_name);
+            response.setError(request.getServerID(), request.getFunctionCode(), ILLEGAL_DATA_ADDRESS);
+            return response;
         }
-        response.setError(request.getServerID(), request.getFunctionCode(), SERVER_DEVICE_FAILURE);
+        entities++;
+        auto entity_buf = std::vector<uint16_t>(mi->registerCount);
+        if (!readEntity(device_type, tag, *mi, entity_buf)) {
+            std::copy(entity_buf.begin(), entity_buf.end(), buf.begin() + (mi->registerOffset - register_offset));
+        }
+    }
+
+    if (!entities) {
+        // combination of device_type/tag_type/register range does not contain any entity
+        LOG_ERROR("combination of device_type/tag_type/register_offset does not exist");
+        response.setError(request.getServerID(), request.getFunctionCode(), ILLEGAL_DATA_ADDRESS);
         return response;
     }
 
@@ -26,6 +26,9 @@ namespace emsesp {
 class Modbus {
   public:
     static const int REGISTER_BLOCK_SIZE = 1000;
+    static const int MAX_READ_REGISTERS  = 125; // protocol limit for a single read request
+
+    static constexpr uint16_t REGISTER_NO_VALUE = 0x8000; // returned for unmapped registers or entities without a value in a block read
 
     void start(uint8_t systemServerId, uint16_t port, uint8_t max_clients, uint32_t timeout);
     void stop();
@@ -91,6 +94,7 @@ class Modbus {
 
     static int8_t tag_to_type(int8_t tag);
     static bool   check_parameter_order();
+    static int    readEntity(const uint8_t device_type, const uint8_t tag, const EntityModbusInfo & modbusInfo, std::vector<uint16_t> & buf);
 
 #ifndef EMSESP_STANDALONE
     ModbusServerTCPasync * modbusServer_;
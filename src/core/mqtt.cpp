@@ -48,6 +48,7 @@ bool        Mqtt::publish_single_;
 bool        Mqtt::publish_single2cmd_;
 
 std::vector<Mqtt::MQTTSubFunction> Mqtt::mqtt_subfunctions_;
+std::unordered_map<uint32_t, uint16_t> Mqtt::subfunction_index_;
 
 uint32_t Mqtt::mqtt_publish_fails_ = 0;
 bool     Mqtt::connecting_         = false;
@@ -62,6 +63,15 @@ std::string Mqtt::lasttopic_    = "";
 std::string Mqtt::lastpayload_  = "";
 std::string Mqtt::lastresponse_ = "";
 
+std::vector<std::pair<uint32_t, uint32_t>> Mqtt::ha_fingerprints_;
+bool                                       Mqtt::ha_fingerprints_dirty_   = false;
+uint32_t                                   Mqtt::ha_fingerprints_changed_ = 0;
+uint32_t                                   Mqtt::ha_configs_sent_         = 0;
+uint32_t                                   Mqtt::ha_configs_skipped_      = 0;
+uint8_t                                    Mqtt::ha_tokens_               = Mqtt::HA_TOKEN_BURST;
+uint32_t                                   Mqtt::ha_tokens_refill_        = 0;
+bool                                       Mqtt::ha_configs_pending_      = false;
+
 // Home Assistant specific
 // icons from https://materialdesignicons.com used with the UOMs (unit of measurements)
 MAKE_WORD(measurement)
@@ -86,6 +96,7 @@ void Mqtt::subscribe(const uint8_t device_type, const std::string & topic, mqtt_
             if ((mqtt_subfunction.device_type_ == device_type) && (strcmp(mqtt_subfunction.topic_.c_str(), topic.c_str()) == 0)) {
                 if (cb) {
                     mqtt_subfunction.mqtt_subfunction_ = cb;
+                    index_subfunctions();
                 }
                 return; // exit - don't add
             }
@@ -96,6 +107,7 @@ void Mqtt::subscribe(const uint8_t device_type, const std::string & topic, mqtt_
     // We store the original topic string without base
     // removed std::move(topic) in 3.7.0-dev.43
     mqtt_subfunctions_.emplace_back(device_type, topic, cb);
+    index_subfunctions();
 
     if (!enabled() || !connected()) {
         return;
@@ -105,6 +117,43 @@ void Mqtt::subscribe(const uint8_t device_type, const std::string & topic, mqtt_
     queue_subscribe_message(topic);
 }
 
+// build the lookup of the subscribed topics by hash of their full topic
+// like the linear search, the first topic with a callback wins
+void Mqtt::index_subfunctions() {
+    subfunction_index_.clear();
+    char full_topic[MQTT_TOPIC_MAX_SIZE];
+    for (uint16_t i = 0; i < mqtt_subfunctions_.size(); i++) {
+        if (mqtt_subfunctions_[i].mqtt_subfunction_) {
+            snprintf(full_topic, sizeof(full_topic), "%s/%s", mqtt_base_.c_str(), mqtt_subfunctions_[i].topic_.c_str());
+            subfunction_index_.emplace(Helpers::hash(full_topic), i);
+        }
+    }
+}
+
+// compares a full topic with base/topic of a subscription
+bool Mqtt::subfunction_matches(const char * topic, const MQTTSubFunction & mf) {
+    return mf.mqtt_subfunction_ && !strncmp(topic, mqtt_base_.c_str(), mqtt_base_.length()) && topic[mqtt_base_.length()] == '/'
+           && !strcmp(topic + mqtt_base_.length() + 1, mf.topic_.c_str());
+}
+
+// returns the subscription with a callback for a full topic, or nullptr
+const Mqtt::MQTTSubFunction * Mqtt::find_subfunction(const char * topic) {
+    auto it = subfunction_index_.find(Helpers::hash(topic));
+    if (it == subfunction_index_.end()) {
+        return nullptr;
+    }
+    if (it->second < mqtt_subfunctions_.size() && subfunction_matches(topic, mqtt_subfunctions_[it->second])) {
+        return &mqtt_subfunctions_[it->second];
+    }
+    // hash collision, search them all
+    for (const auto & mf : mqtt_subfunctions_) {
+        if (subfunction_matches(topic, mf)) {
+            return &mf;
+        }
+    }
+    return nullptr;
+}
+
 // subscribe without storing to subfunctions
 void Mqtt::subscribe(const std::string & topic) {
     // add to MQTT queue as a subscribe operation
@@ -118,6 +167,8 @@ void Mqtt::resubscribe() {
         return;
     }
 
+    index_subfunctions(); // the base may have changed
+
     for (const auto & mqtt_subfunction : mqtt_subfunctions_) {
         queue_subscribe_message(mqtt_subfunction.topic_);
     }
@@ -126,6 +177,9 @@ void Mqtt::resubscribe() {
 // Main MQTT loop - sends out top item on publish queue
 void Mqtt::loop() {
     queuecount_ = mqttClient_->queueSize();
+    if (queuecount_ == 0) {
+        Latency::mqtt_sent(); // publishes caused by a telegram have left the outbox
+    }
 
     // exit if MQTT is not enabled or if there is no network connection
     if (!connected()) {
@@ -134,6 +188,11 @@ void Mqtt::loop() {
 
     uint32_t currentMillis = uuid::get_uptime();
 
+    // persist the HA config fingerprints when no more configs are changing
+    if (ha_fingerprints_dirty_ && (currentMillis - ha_fingerprints_changed_ > HA_FINGERPRINT_SAVE_DELAY)) {
+        ha_fingerprints_save();
+    }
+
     // send heartbeat
     if (currentMillis - last_publish_heartbeat_ > publish_time_heartbeat_) {
         last_publish_heartbeat_ = currentMillis;
@@ -145,6 +204,17 @@ void Mqtt::loop() {
         EMSESP::publish_sensor_values(false);
     }
 
+    // create the HA configs held back by the throttle, at the rate the tokens come in
+    if (ha_configs_pending_ && (currentMillis - last_ha_configs_ >= HA_TOKEN_INTERVAL)) {
+        last_ha_configs_ = currentMillis;
+        if (!ha_enabled_) {
+            ha_configs_pending_ = false;
+        } else if (!ha_throttled()) {
+            ha_configs_pending_ = false;
+            EMSESP::create_ha_configs();
+        }
+    }
+
     // wait for empty queue before sending scheduled device messages
     if (queuecount_ > 0) {
         return;
@@ -194,6 +264,9 @@ void Mqtt::show_mqtt(uuid::console::Shell & shell) {
 
     shell.printfln("MQTT publish errors: %lu", mqtt_publish_fails_);
     shell.printfln("MQTT queue: %d", queuecount_);
+    if (ha_enabled_) {
+        shell.printfln("MQTT HA configs sent: %lu, skipped (unchanged): %lu, known: %d", ha_configs_sent_, ha_configs_skipped_, ha_fingerprints_.size());
+    }
     shell.println();
 
     // show subscriptions
@@ -234,7 +307,7 @@ void Mqtt::on_message(const char * topic, const uint8_t * payload, size_t len) {
     }
 #endif
     // remove HA topics if we don't use discovery
-    if (strncmp(topic, discovery_prefix().c_str(), discovery_prefix().size()) == 0) {
+    if (discovery_prefix_.empty() || (!strncmp(topic, discovery_prefix_.c_str(), discovery_prefix_.length()) && topic[discovery_prefix_.length()] == '/')) {
         if (!ha_enabled_ && len) { // don't ping pong the empty message
             queue_publish_message(topic, "", true);
             LOG_DEBUG("Remove topic %s", topic);
@@ -249,18 +322,13 @@ void Mqtt::on_message(const char * topic, const uint8_t * payload, size_t len) {
     }
 
     // check first against any of our subscribed topics
-    for (const auto & mf : mqtt_subfunctions_) {
-        // add the base back
-        char full_topic[MQTT_TOPIC_MAX_SIZE];
-        snprintf(full_topic, sizeof(full_topic), "%s/%s", Mqtt::base().c_str(), mf.topic_.c_str());
-
-        if ((!strcmp(topic, full_topic)) && (mf.mqtt_subfunction_)) {
-            if (!(mf.mqtt_subfunction_)(message)) {
-                LOG_ERROR("error: invalid payload %s for this topic %s", message, topic);
-                Mqtt::queue_publish("response", "error: invalid data");
-            }
-            return;
+    auto mf = find_subfunction(topic);
+    if (mf) {
+        if (!(mf->mqtt_subfunction_)(message)) {
+            LOG_ERROR("error: invalid payload %s for this topic %s", message, topic);
+            Mqtt::queue_publish("response", "error: invalid data");
         }
+        return;
     }
 
     JsonDocument input_doc;
@@ -383,6 +451,8 @@ void Mqtt::start() {
     // add the 'publish' command ('call system publish' in console or via API)
     Command::add(EMSdevice::DeviceType::SYSTEM, F_(publish), System::command_publish, FL_(publish_cmd));
 
+    ha_fingerprints_load();
+
 #if defined(EMSESP_STANDALONE)
     Mqtt::on_connect(); // simulate an MQTT connection
 #endif
@@ -497,6 +567,7 @@ void Mqtt::on_connect() {
         ha_status();             // create the EMS-ESP device in HA, which is MQTT retained
         ha_climate_reset(true);
     } else {
+        ha_fingerprints_clear(); // the configs on the broker will be removed
         // with disabled HA we subscribe and the broker sends all stored HA-emsesp-configs.
         // Around line 272 they are removed (search for "// remove HA topics if we don't use discover")
         // If HA is enabled the subscriptions are removed.
@@ -591,9 +662,15 @@ void Mqtt::ha_status() {
 
 // add sub or pub task to the queue.
 // the base is not included in the topic
-bool Mqtt::queue_message(const uint8_t operation, const std::string & topic, const std::string & payload, const bool retain) {
+// a json payload is serialized directly into the outgoing packet, otherwise the string payload is used
+bool Mqtt::queue_message(const uint8_t operation, const std::string & topic, const std::string & payload, const bool retain, const JsonObjectConst json) {
     if (topic == "response" && operation == Operation::PUBLISH) {
-        lastresponse_ = payload;
+        if (json.isNull()) {
+            lastresponse_ = payload;
+        } else {
+            lastresponse_.clear();
+            serializeJson(json, lastresponse_);
+        }
         if (!send_response_) {
             return true;
         }
@@ -633,8 +710,15 @@ bool Mqtt::queue_message(const uint8_t operation, const std::string & topic, con
     }
 
     if (operation == Operation::PUBLISH) {
-        packet_id = mqttClient_->publish(fulltopic, mqtt_qos_, retain, payload.c_str());
+        if (json.isNull()) {
+            packet_id = mqttClient_->publish(fulltopic, mqtt_qos_, retain, payload.c_str());
+        } else {
+            packet_id = mqttClient_->publish(fulltopic, mqtt_qos_, retain, measureJson(json), [&json](uint8_t * data, size_t length) {
+                return serializeJson(json, data, length);
+            });
+        }
         mqtt_message_id_++;
+        Latency::mqtt_queued();
         LOG_DEBUG("Publishing topic '%s', pid %d", fulltopic, packet_id);
     } else if (operation == Operation::SUBSCRIBE) {
         packet_id = mqttClient_->subscribe(fulltopic, mqtt_qos_);
@@ -667,6 +751,11 @@ bool Mqtt::queue_publish_message(const std::string & topic, const std::string &
     return queue_message(Operation::PUBLISH, topic, payload, retain);
 }
 
+// internal function to add MQTT message to queue, payload is a json object without an intermediate string
+bool Mqtt::queue_publish_message(const std::string & topic, const JsonObjectConst payload, const bool retain) {
+    return queue_message(Operation::PUBLISH, topic, "", retain, payload);
+}
+
 // MQTT Publish, using the user's retain flag
 bool Mqtt::queue_publish(const std::string & topic, const std::string & payload) {
     return queue_publish_message(topic, payload, mqtt_retain_);
@@ -711,37 +800,165 @@ bool Mqtt::queue_publish_retain(const char * topic, const char * payload) {
     return queue_publish_message(topic, payload, true);
 }
 
-// converts json payload to string, uses any retain flag
+// publish json payload, uses any retain flag
 bool Mqtt::queue_publish(const char * topic, const JsonObjectConst payload, const bool retain) {
     if (payload.size()) {
-        std::string payload_text;
-        payload_text.reserve(measureJson(payload) + 1);
-        serializeJson(payload, payload_text); // convert json to string
-        return queue_publish_message(topic, payload_text, retain);
+        return queue_publish_message(topic, payload, retain);
     }
     return false;
 }
 
+// FNV-1a hash, used as a writer to hash a json payload without serializing it to a buffer
+class FingerprintWriter {
+  public:
+    explicit FingerprintWriter(const char * s = nullptr) {
+        if (s) {
+            write((const uint8_t *)s, strlen(s));
+        }
+    }
+    size_t write(uint8_t c) {
+        hash_ = (hash_ ^ c) * 16777619u;
+        return 1;
+    }
+    size_t write(const uint8_t * s, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            write(s[i]);
+        }
+        return n;
+    }
+    uint32_t hash() const {
+        return hash_;
+    }
+
+  private:
+    uint32_t hash_ = 2166136261u;
+};
+
 // publish empty payload to remove the topic
 bool Mqtt::queue_remove_topic(const char * topic) {
     if (ha_enabled_) {
-        return queue_publish_message(Mqtt::discovery_prefix() + topic, "", true); // publish with retain to remove from broker
+        std::string fulltopic = Mqtt::discovery_prefix() + topic;
+        ha_fingerprint_set(FingerprintWriter(fulltopic.c_str()).hash(), 0); // send again when it's recreated
+        return queue_publish_message(fulltopic, "", true); // publish with retain to remove from broker
     } else {
         return queue_publish_message(topic, "", true); // publish with retain to remove from broker
     }
 }
 
 // queue a Home Assistant config topic and payload, with retain flag set
+// configs which are already on the broker with the same payload are skipped
 bool Mqtt::queue_ha(const char * topic, const JsonObjectConst payload) {
     if (!enabled()) {
         return false;
     }
 
-    std::string payload_text;
-    payload_text.reserve(measureJson(payload) + 1);
-    serializeJson(payload, payload_text); // convert json to string
+    std::string       fulltopic  = Mqtt::discovery_prefix() + topic;
+    uint32_t          topic_hash = FingerprintWriter(fulltopic.c_str()).hash();
+    FingerprintWriter payload_hash;
+    serializeJson(payload, payload_hash);
+
+    auto it = std::lower_bound(ha_fingerprints_.begin(), ha_fingerprints_.end(), std::make_pair(topic_hash, (uint32_t)0));
+    if (it != ha_fingerprints_.end() && it->first == topic_hash && it->second == payload_hash.hash()) {
+        ha_configs_skipped_++;
+        return true;
+    }
+
+    if (!queue_publish_message(fulltopic, payload, true)) { // with retain true
+        return false;
+    }
+
+    ha_configs_sent_++;
+    if (ha_tokens_) {
+        ha_tokens_--;
+    }
+    ha_fingerprint_set(topic_hash, payload_hash.hash());
+    return true;
+}
+
+// token bucket for new HA configs, refilled over time but only while the publish queue is not filling up
+// used to spread the configs of all EMS entities instead of flooding the queue and broker
+bool Mqtt::ha_throttled() {
+    uint32_t now = uuid::get_uptime();
+    if (queuecount_ >= HA_MAX_QUEUED) {
+        ha_tokens_refill_   = now;
+        ha_configs_pending_ = true;
+        return true;
+    }
+    uint32_t tokens = (now - ha_tokens_refill_) / HA_TOKEN_INTERVAL;
+    if (tokens) {
+        ha_tokens_        = std::min<uint32_t>(HA_TOKEN_BURST, ha_tokens_ + tokens);
+        ha_tokens_refill_ = now;
+    }
+    if (!ha_tokens_) {
+        ha_configs_pending_ = true;
+        return true;
+    }
+    return false;
+}
+
+// store the hash of the published payload for a config topic, 0 means not published
+void Mqtt::ha_fingerprint_set(const uint32_t topic_hash, const uint32_t payload_hash) {
+    auto it = std::lower_bound(ha_fingerprints_.begin(), ha_fingerprints_.end(), std::make_pair(topic_hash, (uint32_t)0));
+    if (it != ha_fingerprints_.end() && it->first == topic_hash) {
+        if (payload_hash) {
+            it->second = payload_hash;
+        } else {
+            ha_fingerprints_.erase(it);
+        }
+    } else if (payload_hash) {
+        ha_fingerprints_.insert(it, {topic_hash, payload_hash});
+    } else {
+        return;
+    }
+    ha_fingerprints_dirty_   = true;
+    ha_fingerprints_changed_ = uuid::get_uptime();
+}
+
+// forget all published configs, so they are all sent again
+void Mqtt::ha_fingerprints_clear() {
+    if (!ha_fingerprints_.empty()) {
+        ha_fingerprints_.clear();
+        ha_fingerprints_dirty_   = true;
+        ha_fingerprints_changed_ = uuid::get_uptime();
+    }
+}
+
+// read the HA config fingerprints from the filesystem
+void Mqtt::ha_fingerprints_load() {
+    ha_fingerprints_.clear();
+#ifndef EMSESP_STANDALONE
+    File file = LittleFS.open(EMSESP_HA_FINGERPRINT_FILE, "r");
+    if (file) {
+        size_t count = file.size() / sizeof(ha_fingerprints_[0]);
+        ha_fingerprints_.resize(count);
+        if (file.read((uint8_t *)ha_fingerprints_.data(), count * sizeof(ha_fingerprints_[0])) != count * sizeof(ha_fingerprints_[0])
+            || !std::is_sorted(ha_fingerprints_.begin(), ha_fingerprints_.end())) {
+            ha_fingerprints_.clear(); // corrupt, send all configs
+        }
+        file.close();
+    }
+#endif
+    ha_fingerprints_dirty_ = false;
+    if (!ha_fingerprints_.empty()) {
+        LOG_DEBUG("Loaded %d HA config fingerprints", ha_fingerprints_.size());
+    }
+}
 
-    return queue_publish_message(Mqtt::discovery_prefix() + topic, payload_text, true); // with retain true
+// write the HA config fingerprints to the filesystem
+void Mqtt::ha_fingerprints_save() {
+    ha_fingerprints_dirty_ = false;
+#ifndef EMSESP_STANDALONE
+    if (ha_fingerprints_.empty()) {
+        LittleFS.remove(EMSESP_HA_FINGERPRINT_FILE);
+        return;
+    }
+    File file = LittleFS.open(EMSESP_HA_FINGERPRINT_FILE, "w");
+    if (file) {
+        file.write((const uint8_t *)ha_fingerprints_.data(), ha_fingerprints_.size() * sizeof(ha_fingerprints_[0]));
+        file.close();
+    }
+#endif
+    LOG_DEBUG("Saved %d HA config fingerprints", ha_fingerprints_.size());
 }
 
 // create's a ha sensor config topic from a device value object (dev)
@@ -27,6 +27,8 @@
 #include "command.h"
 #include "emsdevicevalue.h"
 
+#define EMSESP_HA_FINGERPRINT_FILE "/config/emsespHAConfigs.bin"
+
 using uuid::console::Shell;
 
 namespace emsesp {
@@ -84,6 +86,8 @@ class Mqtt {
 
     static bool queue_ha(const char * topic, const JsonObjectConst payload);
     static bool queue_remove_topic(const char * topic);
+    static bool ha_throttled();
+    static void ha_fingerprints_clear();
 
     static bool publish_ha_sensor_config_dv(DeviceValue & dv,
                                             const char *  model,
@@ -145,7 +149,7 @@ class Mqtt {
         mqtt_enabled_ = mqtt_enabled;
     }
 
-    static std::string base() {
+    static const std::string & base() {
         return mqtt_base_;
     }
 
@@ -180,6 +184,14 @@ class Mqtt {
         return queuecount_;
     }
 
+    static uint32_t ha_configs_sent() {
+        return ha_configs_sent_;
+    }
+
+    static uint32_t ha_configs_skipped() {
+        return ha_configs_skipped_;
+    }
+
     static uint8_t connect_count() {
         return connectcount_;
     }
@@ -269,11 +281,20 @@ class Mqtt {
     static MqttClient * mqttClient_;
     static uint32_t     mqtt_message_id_;
 
-    static bool queue_message(const uint8_t operation, const std::string & topic, const std::string & payload, const bool retain);
+    static bool queue_message(const uint8_t         operation,
+                              const std::string &   topic,
+                              const std::string &   payload,
+                              const bool            retain,
+                              const JsonObjectConst json = JsonObjectConst());
     static bool queue_publish_message(const std::string & topic, const std::string & payload, const bool retain);
+    static bool queue_publish_message(const std::string & topic, const JsonObjectConst payload, const bool retain);
     static void queue_subscribe_message(const std::string & topic);
     static void queue_unsubscribe_message(const std::string & topic);
 
+    static void ha_fingerprints_load();
+    static void ha_fingerprints_save();
+    static void ha_fingerprint_set(const uint32_t topic_hash, const uint32_t payload_hash);
+
     void on_publish(uint16_t packetId) const;
 
     // function handlers for MQTT subscriptions
@@ -290,7 +311,12 @@ class Mqtt {
         }
     };
 
-    static std::vector<MQTTSubFunction> mqtt_subfunctions_; // list of mqtt subscribe callbacks for all devices
+    static std::vector<MQTTSubFunction>            mqtt_subfunctions_; // list of mqtt subscribe callbacks for all devices
+    static std::unordered_map<uint32_t, uint16_t> subfunction_index_; // hash of the full topic -> first entry with a callback
+
+    static void                    index_subfunctions();
+    static const MQTTSubFunction * find_subfunction(const char * topic);
+    static bool                    subfunction_matches(const char * topic, const MQTTSubFunction & mf);
 
     uint32_t last_publish_boiler_     = 0;
     uint32_t last_publish_thermostat_ = 0;
@@ -300,6 +326,7 @@ class Mqtt {
     uint32_t last_publish_other_      = 0;
     uint32_t last_publish_sensor_     = 0;
     uint32_t last_publish_heartbeat_  = 0;
+    uint32_t last_ha_configs_         = 0;
     // uint32_t last_publish_queue_      = 0;
 
     static bool     connecting_;
@@ -313,6 +340,22 @@ class Mqtt {
     static std::string lastpayload_;
     static std::string lastresponse_;
 
+    // HA discovery configs, a sorted list of the topic hash and the hash of the last published payload
+    // persisted so unchanged configs are not sent again after a reconnect or restart
+    static constexpr uint32_t HA_FINGERPRINT_SAVE_DELAY = 30000; // ms after the last change
+    static constexpr uint8_t  HA_TOKEN_BURST            = 10;    // max configs sent in one go
+    static constexpr uint16_t HA_TOKEN_INTERVAL         = 200;   // ms, one new token
+    static constexpr uint16_t HA_MAX_QUEUED             = 20;    // hold back configs while the queue is filling up
+
+    static std::vector<std::pair<uint32_t, uint32_t>> ha_fingerprints_;
+    static bool                                       ha_fingerprints_dirty_;
+    static uint32_t                                   ha_fingerprints_changed_;
+    static uint32_t                                   ha_configs_sent_;
+    static uint32_t                                   ha_configs_skipped_;
+    static uint8_t                                    ha_tokens_;
+    static uint32_t                                   ha_tokens_refill_;
+    static bool                                       ha_configs_pending_;
+
     // settings, copied over
     static std::string mqtt_base_;
     static std::string mqtt_basename_; // base name for MQTT topics with / replaced with _
@@ -0,0 +1,307 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020-2024  emsesp.org - proddy, MichaelDvP
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "profiler.h"
+#include "emsesp.h"
+
+namespace emsesp {
+
+bool        Profiler::enabled_       = false;
+bool        Profiler::running_       = false;
+uint32_t    Profiler::cycles_per_us_ = 1;
+uint32_t    Profiler::since_         = 0;
+TimingStats Profiler::stats_[Profiler::STAGES];
+
+// upper limits of the histogram buckets, the last bucket has no limit
+static constexpr const char * bucket_names[TimingStats::BUCKETS] = {"<16us", "<64us", "<256us", "<1ms", "<4ms", "<16ms", "<64ms", "<256ms", ">256ms"};
+
+void TimingStats::reset() {
+    count_    = 0;
+    min_us_   = UINT32_MAX;
+    max_us_   = 0;
+    total_us_ = 0;
+    memset(buckets_, 0, sizeof(buckets_));
+}
+
+void TimingStats::add(const uint32_t us) {
+    uint8_t bucket = 0;
+    while (bucket < BUCKETS - 1 && us >= (16UL << (2 * bucket))) {
+        bucket++;
+    }
+
+    count_++;
+    total_us_ += us;
+    buckets_[bucket]++;
+    if (us < min_us_) {
+        min_us_ = us;
+    }
+    if (us > max_us_) {
+        max_us_ = us;
+    }
+}
+
+void TimingStats::show_header(uuid::console::Shell & shell) {
+    shell.printf(" %-17s %7s %7s %7s", "stage", "min", "avg", "max");
+    for (const auto name : bucket_names) {
+        shell.printf(" %7s", name);
+    }
+    shell.println();
+}
+
+void TimingStats::show(uuid::console::Shell & shell, const char * name) const {
+    if (!count_) {
+        return;
+    }
+    shell.printf(" %-17s %7u %7u %7u", name, min_us_, (uint32_t)(total_us_ / count_), max_us_);
+    for (const auto count : buckets_) {
+        shell.printf(" %7u", count);
+    }
+    shell.println();
+}
+
+void TimingStats::info(JsonObject output) const {
+    output["count"] = count_;
+    output["min"]   = min_us_;
+    output["avg"]   = (uint32_t)(total_us_ / count_);
+    output["max"]   = max_us_;
+    JsonArray hist  = output["hist"].to<JsonArray>();
+    for (const auto count : buckets_) {
+        hist.add(count);
+    }
+}
+
+const char * Profiler::stage_name(const uint8_t stage) {
+    switch (stage) {
+    case WEB:
+        return "web";
+    case SYSTEM:
+        return "system";
+    case WEBLOG:
+        return "weblog";
+    case RX:
+        return "rx";
+    case SHOWER:
+        return "shower";
+    case TEMPERATURESENSOR:
+        return "temperaturesensor";
+    case ANALOGSENSOR:
+        return "analogsensor";
+    case PUBLISH:
+        return "publish";
+    case MQTT:
+        return "mqtt";
+    case MODULES:
+        return "modules";
+    case SCHEDULER:
+        return "scheduler";
+    case FETCH:
+        return "fetch";
+    case VALIDATE:
+        return "validate";
+    case SHELL:
+        return "shell";
+    case LOOP:
+        return "loop";
+    default:
+        return "";
+    }
+}
+
+void Profiler::enabled(const bool enable) {
+    if (enable && !enabled_) {
+        reset();
+    }
+    enabled_ = enable;
+}
+
+void Profiler::reset() {
+#if defined(EMSESP_STANDALONE)
+    cycles_per_us_ = 1;
+#else
+    cycles_per_us_ = ESP.getCpuFreqMHz();
+#endif
+    since_ = uuid::get_uptime_sec();
+    for (auto & stats : stats_) {
+        stats.reset();
+    }
+}
+
+// shell command 'show perf'
+void Profiler::show(uuid::console::Shell & shell) {
+    if (!enabled_) {
+        shell.printfln("Loop profiler is disabled, enable with 'call system perf on'");
+        return;
+    }
+
+    shell.printfln("Loop profiler, %u loops in %u seconds (times in us):", stats_[LOOP].count(), uuid::get_uptime_sec() - since_);
+    TimingStats::show_header(shell);
+    for (uint8_t i = 0; i < STAGES; i++) {
+        stats_[i].show(shell, stage_name(i));
+    }
+    shell.println();
+}
+
+void Profiler::info(JsonObject output) {
+    output["enabled"] = enabled_;
+    if (!enabled_) {
+        return;
+    }
+    output["seconds"] = uuid::get_uptime_sec() - since_;
+
+    for (uint8_t i = 0; i < STAGES; i++) {
+        if (stats_[i].count()) {
+            stats_[i].info(output[stage_name(i)].to<JsonObject>());
+        }
+    }
+}
+
+// diagnostic MQTT topic, sent with the heartbeat while the profiler is running
+void Profiler::publish() {
+    if (!enabled_) {
+        return;
+    }
+
+    JsonDocument doc;
+    info(doc.to<JsonObject>());
+    Mqtt::queue_publish("perf", doc.as<JsonObject>());
+}
+
+// api/system/perf, returns the stats or takes on, off or reset
+bool Profiler::command_perf(const char * value, const int8_t id, JsonObject output) {
+    if (value && strlen(value)) {
+        bool b;
+        if (!strcmp(value, "reset")) {
+            reset();
+        } else if (Helpers::value2bool(value, b)) {
+            enabled(b);
+        } else {
+            return false;
+        }
+    }
+
+    info(output);
+    return true;
+}
+
+uint32_t              Latency::received_      = 0;
+Latency::Pending      Latency::pending_[Latency::MAX_PENDING];
+uint8_t               Latency::pending_count_ = 0;
+std::atomic<uint32_t> Latency::tx_sent_{0};
+std::atomic<uint32_t> Latency::tx_read_us_{0};
+std::atomic<uint32_t> Latency::tx_write_us_{0};
+TimingStats           Latency::stats_[Latency::STAGES];
+
+const char * Latency::stage_name(const uint8_t stage) {
+    switch (stage) {
+    case RING:
+        return "ring";
+    case HANDLER:
+        return "handler";
+    case MQTT_QUEUE:
+        return "mqttqueue";
+    case MQTT_SEND:
+        return "mqttsend";
+    case TOTAL:
+        return "total";
+    case TX_READ:
+        return "txread";
+    case TX_WRITE:
+        return "txwrite";
+    default:
+        return "";
+    }
+}
+
+// a publish was queued, measure it if it's caused by a received telegram
+void Latency::mqtt_queued() {
+    if (!received_) {
+        return;
+    }
+    add(MQTT_QUEUE, received_);
+    if (pending_count_ < MAX_PENDING) {
+        pending_[pending_count_++] = {received_, now()};
+    }
+}
+
+// the MQTT outbox is empty, all pending publishes have left
+void Latency::mqtt_sent() {
+    for (uint8_t i = 0; i < pending_count_; i++) {
+        add(MQTT_SEND, pending_[i].queued);
+        add(TOTAL, pending_[i].received);
+    }
+    pending_count_ = 0;
+}
+
+// a reply to our last Tx, called from the UART task
+void Latency::tx_replied(const bool write) {
+    uint32_t sent = tx_sent_.exchange(0, std::memory_order_relaxed);
+    if (sent) {
+        (write ? tx_write_us_ : tx_read_us_).store(std::max(now() - sent, (uint32_t)1), std::memory_order_relaxed);
+    }
+}
+
+// collect the Tx round trips measured in the UART task
+void Latency::loop() {
+    uint32_t us = tx_read_us_.exchange(0, std::memory_order_relaxed);
+    if (us) {
+        stats_[TX_READ].add(us);
+    }
+    us = tx_write_us_.exchange(0, std::memory_order_relaxed);
+    if (us) {
+        stats_[TX_WRITE].add(us);
+    }
+}
+
+void Latency::reset() {
+    for (auto & stats : stats_) {
+        stats.reset();
+    }
+}
+
+// shell command 'show latency'
+void Latency::show(uuid::console::Shell & shell) {
+    shell.printfln("Telegram latency (times in us):");
+    TimingStats::show_header(shell);
+    for (uint8_t i = 0; i < STAGES; i++) {
+        stats_[i].show(shell, stage_name(i));
+    }
+    shell.println();
+}
+
+void Latency::info(JsonObject output) {
+    for (uint8_t i = 0; i < STAGES; i++) {
+        if (stats_[i].count()) {
+            stats_[i].info(output[stage_name(i)].to<JsonObject>());
+        }
+    }
+}
+
+// api/system/latency, returns the stats, reset with value reset
+bool Latency::command_latency(const char * value, const int8_t id, JsonObject output) {
+    if (value && strlen(value)) {
+        if (strcmp(value, "reset")) {
+            return false;
+        }
+        reset();
+    }
+
+    info(output);
+    return true;
+}
+
+} // namespace emsesp
@@ -0,0 +1,177 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020-2024  emsesp.org - proddy, MichaelDvP
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EMSESP_PROFILER_H
+#define EMSESP_PROFILER_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+#include <uuid/console.h>
+
+#include <atomic>
+#if defined(EMSESP_STANDALONE)
+#include <chrono>
+#else
+#include <esp_timer.h>
+#endif
+
+namespace emsesp {
+
+// count, min/avg/max and a histogram of durations in us
+class TimingStats {
+  public:
+    // bucket i counts durations below 16us << 2i, the last one everything above 256ms
+    static constexpr uint8_t BUCKETS = 9;
+
+    TimingStats() {
+        reset();
+    }
+
+    void reset();
+    void add(const uint32_t us);
+
+    uint32_t count() const {
+        return count_;
+    }
+
+    void        show(uuid::console::Shell & shell, const char * name) const;
+    void        info(JsonObject output) const;
+    static void show_header(uuid::console::Shell & shell);
+
+  private:
+    uint32_t count_;
+    uint32_t min_us_;
+    uint32_t max_us_;
+    uint64_t total_us_;
+    uint32_t buckets_[BUCKETS];
+};
+
+// Timing of the stages in EMSESP::loop(), with min/avg/max and a histogram per stage
+// Uses the CPU cycle counter, when disabled each stage costs a single test of a flag
+class Profiler {
+  public:
+    enum Stage : uint8_t { WEB, SYSTEM, WEBLOG, RX, SHOWER, TEMPERATURESENSOR, ANALOGSENSOR, PUBLISH, MQTT, MODULES, SCHEDULER, FETCH, VALIDATE, SHELL, LOOP, STAGES };
+
+    static bool enabled() {
+        return enabled_;
+    }
+    static void enabled(const bool enable);
+    static void reset();
+
+    // start of a loop, returns the cycle count to pass to lap()
+    static uint32_t start() {
+        running_ = enabled_; // enabling takes effect with the next loop
+        return running_ ? cycles() : 0;
+    }
+
+    // ends a stage, returns the cycle count as start of the next stage
+    static uint32_t lap(const Stage stage, const uint32_t since) {
+        if (!running_) {
+            return 0;
+        }
+        uint32_t now = cycles();
+        stats_[stage].add((now - since) / cycles_per_us_);
+        return now;
+    }
+
+    static void show(uuid::console::Shell & shell);
+    static void info(JsonObject output);
+    static void publish();
+
+    static bool command_perf(const char * value, const int8_t id, JsonObject output);
+
+  private:
+    static uint32_t cycles() {
+#if defined(EMSESP_STANDALONE)
+        return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#else
+        return ESP.getCycleCount();
+#endif
+    }
+
+    static const char * stage_name(const uint8_t stage);
+
+    static bool        enabled_;
+    static bool        running_; // profiling the current loop
+    static uint32_t    cycles_per_us_;
+    static uint32_t    since_; // uptime in seconds when the stats were reset
+    static TimingStats stats_[STAGES];
+};
+
+// Latency of received telegrams from the UART up to the MQTT outbox, and of our Tx requests until the reply
+// Frames are stamped in the UART task with esp_timer_get_time(), the stamp follows the telegram through
+// the Rx ring and queue, the handler and the MQTT publishes it causes
+class Latency {
+  public:
+    enum Stage : uint8_t { RING, HANDLER, MQTT_QUEUE, MQTT_SEND, TOTAL, TX_READ, TX_WRITE, STAGES };
+
+    static uint32_t now() {
+        return (uint32_t)esp_timer_get_time();
+    }
+
+    static void add(const Stage stage, const uint32_t since) {
+        stats_[stage].add(now() - since);
+    }
+
+    // the received telegram being processed, 0 when done
+    static void telegram(const uint32_t received) {
+        received_ = received;
+    }
+    static uint32_t received() {
+        return received_;
+    }
+
+    static void mqtt_queued();
+    static void mqtt_sent();
+
+    // called from the UART task
+    static void tx_sent() {
+        tx_sent_.store(now(), std::memory_order_relaxed);
+    }
+    static void tx_replied(const bool write);
+
+    static void loop();
+    static void reset();
+    static void show(uuid::console::Shell & shell);
+    static void info(JsonObject output);
+
+    static bool command_latency(const char * value, const int8_t id, JsonObject output);
+
+  private:
+    static constexpr uint8_t MAX_PENDING = 16; // publishes waiting in the MQTT outbox
+
+    struct Pending {
+        uint32_t received;
+        uint32_t queued;
+    };
+
+    static const char * stage_name(const uint8_t stage);
+
+    static uint32_t              received_;
+    static Pending               pending_[MAX_PENDING];
+    static uint8_t               pending_count_;
+    static std::atomic<uint32_t> tx_sent_;
+    static std::atomic<uint32_t> tx_read_us_; // round trips handed over from the UART task, 0 if none
+    static std::atomic<uint32_t> tx_write_us_;
+    static TimingStats           stats_[STAGES];
+};
+
+} // namespace emsesp
+
+#endif
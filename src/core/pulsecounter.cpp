@@ -0,0 +1,139 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020-2024  emsesp.org - proddy, MichaelDvP
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pulsecounter.h"
+
+#ifndef EMSESP_STANDALONE
+#include <hal/gpio_ll.h>
+#endif
+
+#if defined(EMSESP_STANDALONE)
+#define IRAM_ATTR
+#define PULSE_ENTER_CRITICAL()
+#define PULSE_EXIT_CRITICAL()
+#else
+static portMUX_TYPE pulse_mux = portMUX_INITIALIZER_UNLOCKED;
+#define PULSE_ENTER_CRITICAL() portENTER_CRITICAL(&pulse_mux)
+#define PULSE_EXIT_CRITICAL() portEXIT_CRITICAL(&pulse_mux)
+#endif
+
+namespace emsesp {
+
+// the level before a change was stable long enough, take it as the debounced level
+// a falling edge counts with the time it started
+void IRAM_ATTR PulseCounter::settle(Channel & channel, const uint32_t ms) {
+    if (channel.level != channel.stable && ms - channel.changed_ms >= DEBOUNCE_MS) {
+        channel.stable = channel.level;
+        if (!channel.stable) {
+            channel.count++;
+            channel.prev_ms = channel.last_ms;
+            channel.last_ms = channel.changed_ms;
+        }
+    }
+}
+
+void IRAM_ATTR PulseCounter::change(Channel & channel, const int level, const uint32_t ms) {
+    if (level == channel.level) {
+        return;
+    }
+    settle(channel, ms);
+    channel.level      = level;
+    channel.changed_ms = ms;
+}
+
+#ifndef EMSESP_STANDALONE
+void IRAM_ATTR PulseCounter::isr(void * arg) {
+    auto channel = static_cast<Channel *>(arg);
+    portENTER_CRITICAL_ISR(&pulse_mux);
+    change(*channel, gpio_ll_get_level(&GPIO, (gpio_num_t)channel->gpio), now());
+    portEXIT_CRITICAL_ISR(&pulse_mux);
+}
+#endif
+
+PulseCounter::Channel * PulseCounter::find(const uint8_t gpio) {
+    for (uint8_t i = 0; i < num_channels_; i++) {
+        if (channels_[i].gpio == gpio) {
+            return &channels_[i];
+        }
+    }
+    return nullptr;
+}
+
+// start counting on an input, the pin mode must be set
+bool PulseCounter::attach(const uint8_t gpio) {
+    if (find(gpio) || num_channels_ >= MAX_CHANNELS) {
+        return false;
+    }
+
+    Channel & channel  = channels_[num_channels_];
+    channel.gpio       = gpio;
+    channel.level      = digitalRead(gpio);
+    channel.stable     = channel.level;
+    channel.count      = 0;
+    channel.last_ms    = now();
+    channel.prev_ms    = channel.last_ms;
+    channel.since_ms   = channel.last_ms;
+    channel.changed_ms = channel.last_ms;
+    num_channels_++;
+
+#ifndef EMSESP_STANDALONE
+    attachInterruptArg(gpio, isr, &channel, CHANGE);
+#endif
+    return true;
+}
+
+void PulseCounter::detach_all() {
+#ifndef EMSESP_STANDALONE
+    for (uint8_t i = 0; i < num_channels_; i++) {
+        detachInterrupt(channels_[i].gpio);
+    }
+#endif
+    num_channels_ = 0;
+}
+
+// hands over and clears the falling edges counted since the last call, returns true if there are any
+bool PulseCounter::collect(const uint8_t gpio, Pulses & pulses) {
+    Channel * channel = find(gpio);
+    if (!channel) {
+        return false;
+    }
+
+    PULSE_ENTER_CRITICAL();
+    settle(*channel, now()); // the input may not have changed since the last edge
+    pulses.count      = channel->count;
+    pulses.last_ms    = channel->last_ms;
+    pulses.prev_ms    = channel->prev_ms;
+    pulses.since_ms   = channel->since_ms;
+    channel->count    = 0;
+    channel->since_ms = channel->last_ms;
+    PULSE_EXIT_CRITICAL();
+
+    return pulses.count > 0;
+}
+
+// a level change on the input, called by the simulation and the tests
+void PulseCounter::edge(const uint8_t gpio, const int level, const uint32_t ms) {
+    Channel * channel = find(gpio);
+    if (channel) {
+        PULSE_ENTER_CRITICAL();
+        change(*channel, level, ms);
+        PULSE_EXIT_CRITICAL();
+    }
+}
+
+} // namespace emsesp
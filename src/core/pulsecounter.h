@@ -0,0 +1,78 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020-2024  emsesp.org - proddy, MichaelDvP
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EMSESP_PULSECOUNTER_H
+#define EMSESP_PULSECOUNTER_H
+
+#include <Arduino.h>
+
+namespace emsesp {
+
+// Edge capture for the COUNTER, TIMER and RATE analog sensors
+// A GPIO interrupt on both edges debounces the input and counts the falling edges with their time,
+// so pulses are not lost when the loop stalls. The loop picks up the totals with collect().
+// In the standalone build there is no interrupt, the edges are fed in with edge() by the tests
+class PulseCounter {
+  public:
+    static constexpr uint8_t  MAX_CHANNELS = 20; // one per analog sensor
+    static constexpr uint32_t DEBOUNCE_MS  = 15; // a level must be stable this long to count
+
+    // the falling edges since the last collect
+    struct Pulses {
+        uint32_t count;
+        uint32_t last_ms;  // time of the last falling edge
+        uint32_t prev_ms;  // time of the falling edge before the last one
+        uint32_t since_ms; // time of the last falling edge of the previous collect
+    };
+
+    // time base of the edges, millis() is safe to call from the interrupt
+    static uint32_t now() {
+        return (uint32_t)millis();
+    }
+
+    bool attach(const uint8_t gpio);
+    void detach_all();
+    bool collect(const uint8_t gpio, Pulses & pulses);
+    void edge(const uint8_t gpio, const int level, const uint32_t ms);
+
+  private:
+    struct Channel {
+        uint8_t  gpio;
+        int      level;      // last level seen
+        int      stable;     // debounced level
+        uint32_t changed_ms; // time of the last level change
+        uint32_t count;
+        uint32_t last_ms;
+        uint32_t prev_ms;
+        uint32_t since_ms;
+    };
+
+    Channel *   find(const uint8_t gpio);
+    static void settle(Channel & channel, const uint32_t ms);
+    static void change(Channel & channel, const int level, const uint32_t ms);
+#ifndef EMSESP_STANDALONE
+    static void IRAM_ATTR isr(void * arg);
+#endif
+
+    Channel channels_[MAX_CHANNELS];
+    uint8_t num_channels_ = 0;
+};
+
+} // namespace emsesp
+
+#endif
@@ -20,6 +20,9 @@
 #include <string>
 #include <vector>
 #include <deque>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
 #include <math.h>
 
 class Token {
@@ -34,6 +37,7 @@ class Token {
         Unary,
         LeftParen,
         RightParen,
+        Entity, // placeholder for an entity value in a compiled expression
     };
 
     Token(Type type, const std::string & s, int8_t precedence = -1, bool rightAssociative = false)
@@ -135,6 +139,8 @@ std::deque<Token> exprToTokens(const std::string & expr) {
             if (*p == '\0') {
                 --p;
             }
+        } else if (*p == '\x01') { // entity placeholder, see compile_expression()
+            tokens.emplace_back(Token::Type::Entity, "", -3);
         } else if (isdigit(*p)) {
             const auto * b = p;
             while (isdigit(*p) || *p == '.') {
@@ -258,6 +264,7 @@ std::deque<Token> shuntingYard(const std::deque<Token> & tokens) {
         switch (token.type) {
         case Token::Type::Number:
         case Token::Type::String:
+        case Token::Type::Entity:
             // If the token is a number, then add it to the output queue
             queue.push_back(token);
             break;
@@ -439,8 +446,8 @@ std::string to_hex(uint32_t i) {
     return s;
 }
 
-// RPN calculator
-std::string calculate(const std::string & expr) {
+// RPN calculator working on strings, used for expressions which can't be compiled
+std::string calculate_text(const std::string & expr) {
     std::string expr_new = expr;
     commands(expr_new);
 
@@ -661,6 +668,7 @@ std::string calculate(const std::string & expr) {
         } break;
         case Token::Type::LeftParen:
         case Token::Type::RightParen:
+        case Token::Type::Entity:
         case Token::Type::Unknown:
         default:
             return "";
@@ -676,9 +684,510 @@ std::string calculate(const std::string & expr) {
     return result;
 }
 
+// a value on the stack of a compiled expression, numbers are kept as double
+struct ExprValue {
+    bool        is_num = false;
+    double      num    = 0;
+    std::string str; // a string, or the text of a number literal or entity value. Empty for calculated numbers
+
+    static ExprValue from_text(const std::string & s) {
+        ExprValue v;
+        v.is_num = isnum(s);
+        v.num    = v.is_num ? strtod(s.c_str(), nullptr) : 0;
+        v.str    = s;
+        return v;
+    }
+
+    static ExprValue number(double d) {
+        if (!std::isfinite(d)) {
+            return from_text(to_string(d)); // inf and nan are strings
+        }
+        // round to the 6 decimals the text calculator keeps, so 0.1 + 0.2 == 0.3 stays true
+        if (std::fabs(d) < 1e12) {
+            d = std::round(d * 1e6) / 1e6;
+        }
+        ExprValue v;
+        v.is_num = true;
+        v.num    = d;
+        return v;
+    }
+
+    std::string text() const {
+        return (is_num && str.empty()) ? to_string(num) : str;
+    }
+
+    // like std::stod, fails if the text doesn't start with a number
+    bool to_double(double & d) const {
+        if (is_num) {
+            d = num;
+            return true;
+        }
+        char * end;
+        d = strtod(str.c_str(), &end);
+        return end != str.c_str();
+    }
+};
+
+// an entity in an expression, bound to its command
+struct ExprEntity {
+    std::string path; // api path, e.g. api/thermostat/hc1/seltemp/value
+    uint8_t     device_type = emsesp::EMSdevice::DeviceType::UNKNOWN;
+    int8_t      id          = -1;
+    std::string cmd;        // command without the device and id, e.g. seltemp/value
+    int8_t      value = -1; // or the index of a value fetched by compute(), see VALUE_MARK
+};
+
+// a numeric result of an url request is left in the expression as VALUE_MARK and its index,
+// so the expression text and its cache entry stay the same when the value changes
+static constexpr char    VALUE_MARK = '\x02';
+static constexpr uint8_t MAX_VALUES = 16; // index is sent as 0x10 + i
+
+// one step of a compiled expression in RPN order
+struct ExprOp {
+    Token::Type type;
+    char        op     = 0;  // operator for Unary, Compare, Logic and Operator
+    int8_t      entity = -1; // index in entities for Entity
+    ExprValue   value;       // Number and String literals
+};
+
+struct ExprProgram {
+    bool                    compiled = false; // if not, the expression is evaluated with calculate_text()
+    std::vector<ExprOp>     ops;
+    std::vector<ExprEntity> entities;
+};
+
+// resolve the entity path like Command::process() does for an api call without body
+ExprEntity bind_entity(const char * cmd) {
+    ExprEntity entity;
+    entity.path = "api/" + std::string(cmd);
+
+    emsesp::SUrlParser p;
+    p.parse(entity.path.c_str());
+    if (p.paths().size() && p.paths().front() == "api") {
+        p.paths().erase(p.paths().begin());
+    }
+    size_t num_paths = p.paths().size();
+    if (!num_paths) {
+        return entity;
+    }
+    uint8_t device_type = emsesp::EMSdevice::device_name_2_device_type(p.paths().front().c_str());
+
+    char         command[COMMAND_MAX_LENGTH];
+    const char * command_p = nullptr;
+    if (num_paths == 2) {
+        command_p = p.paths()[1].c_str();
+    } else if (num_paths == 3) {
+        snprintf(command, sizeof(command), "%s/%s", p.paths()[1].c_str(), p.paths()[2].c_str());
+        command_p = command;
+    } else if (num_paths > 3) {
+        snprintf(command, sizeof(command), "%s/%s/%s", p.paths()[1].c_str(), p.paths()[2].c_str(), p.paths()[3].c_str());
+        command_p = command;
+    }
+    int8_t id = -1;
+    if (device_type >= emsesp::EMSdevice::DeviceType::BOILER) {
+        command_p = emsesp::Command::parse_command_string(command_p, id);
+    }
+    if (command_p == nullptr) {
+        if (num_paths < (id > 0 ? 4 : 3)) {
+            command_p = F_(values);
+        } else {
+            return entity;
+        }
+    }
+    entity.device_type = device_type;
+    entity.id          = id;
+    entity.cmd         = command_p;
+    return entity;
+}
+
+// compile an expression to RPN once, with the entities replaced by placeholders bound to their commands
+// the entities are found the same way as in commands()
+ExprProgram compile_expression(const std::string & expr) {
+    ExprProgram                                 program;
+    std::string                                 expr_new = expr;
+    auto                                        lower    = emsesp::Helpers::toLower(expr);
+    std::vector<std::pair<size_t, ExprEntity>> found; // position of the placeholder and entity
+
+    for (uint8_t device = 0; device < emsesp::EMSdevice::DeviceType::UNKNOWN; device++) {
+        const char * d = emsesp::EMSdevice::device_type_2_device_name(device);
+        auto         f = lower.find(d);
+        while (f != std::string::npos) {
+            auto e = lower.find_first_not_of("/._abcdefghijklmnopqrstuvwxyz0123456789", f);
+            if (e == std::string::npos) {
+                e = lower.length();
+            }
+            char   cmd[COMMAND_MAX_LENGTH];
+            size_t l = e - f;
+            if (l >= sizeof(cmd) - 1) {
+                break;
+            }
+            lower.copy(cmd, l, f);
+            cmd[l] = '\0';
+            if (strstr(cmd, "/value") == nullptr) {
+                strlcat(cmd, "/value", sizeof(cmd) - 6);
+            }
+            for (auto & fe : found) {
+                if (fe.first > f) {
+                    fe.first -= l - 1;
+                }
+            }
+            found.emplace_back(f, bind_entity(cmd));
+            expr_new.replace(f, l, 1, '\x01');
+            lower.replace(f, l, 1, '\x01');
+            f = lower.find(d, f + 1);
+        }
+    }
+
+    // values fetched by compute()
+    auto f = expr_new.find(VALUE_MARK);
+    while (f != std::string::npos && f + 1 < expr_new.length()) {
+        for (auto & fe : found) {
+            if (fe.first > f) {
+                fe.first -= 1;
+            }
+        }
+        ExprEntity entity;
+        entity.value = expr_new[f + 1] - 0x10;
+        found.emplace_back(f, std::move(entity));
+        expr_new.replace(f, 2, 1, '\x01');
+        f = expr_new.find(VALUE_MARK, f + 1);
+    }
+    std::sort(found.begin(), found.end(), [](const std::pair<size_t, ExprEntity> & a, const std::pair<size_t, ExprEntity> & b) { return a.first < b.first; });
+
+    const auto tokens = exprToTokens(expr_new);
+    size_t     n      = 0;
+    for (const auto & t : tokens) {
+        n += (t.type == Token::Type::Entity) ? 1 : 0;
+    }
+    if (n != found.size()) {
+        return program; // a placeholder ended up in a string, can't compile
+    }
+
+    program.compiled = true;
+    for (auto & fe : found) {
+        program.entities.push_back(std::move(fe.second));
+    }
+
+    // operands keep their order in the RPN queue, so the n-th Entity token is the n-th entity
+    int8_t entity = 0;
+    for (const auto & t : shuntingYard(tokens)) {
+        ExprOp op;
+        op.type = t.type;
+        if (t.type == Token::Type::Number || t.type == Token::Type::String) {
+            op.value = ExprValue::from_text(t.str);
+        } else if (t.type == Token::Type::Entity) {
+            op.entity = entity++;
+        } else {
+            op.op = t.str[0];
+        }
+        program.ops.push_back(std::move(op));
+    }
+    return program;
+}
+
+// evaluate a compiled expression, same results as calculate_text()
+std::string evaluate(const ExprProgram & program, const std::vector<std::string> & values) {
+    if (program.ops.empty()) {
+        return "";
+    }
+
+    std::vector<ExprValue> stack;
+    JsonDocument           doc;
+
+    for (const auto & op : program.ops) {
+        switch (op.type) {
+        case Token::Type::Number:
+        case Token::Type::String:
+            stack.push_back(op.value);
+            break;
+        case Token::Type::Entity: {
+            const auto & entity = program.entities[op.entity];
+            if (entity.value >= 0) {
+                if (entity.value >= (int8_t)values.size()) {
+                    return "";
+                }
+                stack.push_back(ExprValue::from_text(values[entity.value]));
+                break;
+            }
+            JsonObject output = doc.to<JsonObject>();
+            uint8_t      return_code;
+            if (!entity.cmd.empty() && emsesp::Command::device_has_commands(entity.device_type)) {
+                return_code = emsesp::Command::call(entity.device_type, entity.cmd.c_str(), "", true, entity.id, output);
+            } else {
+                // not bound or the device is not there (yet), let process() report the error
+                JsonDocument doc_in;
+                return_code = emsesp::Command::process(entity.path.c_str(), true, doc_in.to<JsonObject>(), output);
+            }
+            // check for no value (entity is valid but has no value set)
+            if (return_code != emsesp::CommandRet::OK && return_code != emsesp::CommandRet::NO_VALUE) {
+                return "";
+            }
+            stack.push_back(ExprValue::from_text(output["api_data"] | ""));
+        } break;
+        case Token::Type::Unary: {
+            if (stack.empty()) {
+                return "";
+            }
+            const auto rhs = std::move(stack.back());
+            stack.pop_back();
+            if (op.op == '!') {
+                auto l = to_logic(rhs.text());
+                if (l >= 0) {
+                    stack.push_back(ExprValue::number(l == 0 ? 1 : 0));
+                } else if (rhs.is_num) {
+                    stack.push_back(ExprValue::number(rhs.num == 0 ? 1 : 0));
+                } else {
+                    emsesp::EMSESP::logger().warning("missing operator");
+                    return "";
+                }
+                break;
+            }
+            double rhd;
+            if (!rhs.to_double(rhd)) {
+                return "";
+            }
+            switch (op.op) {
+            default:
+                return "";
+            case 'm': // Special operator name for unary '-'
+                stack.push_back(ExprValue::number(-1 * rhd));
+                break;
+            case 'i':
+                stack.push_back(ExprValue::number(static_cast<int>(rhd)));
+                break;
+            case 'r':
+                stack.push_back(ExprValue::number(std::round(rhd)));
+                break;
+            case 'a':
+                stack.push_back(ExprValue::number(std::abs(rhd)));
+                break;
+            case 'e':
+                stack.push_back(ExprValue::number(std::exp(rhd)));
+                break;
+            case 'l':
+                stack.push_back(ExprValue::number(std::log(rhd)));
+                break;
+            case 'g':
+                stack.push_back(ExprValue::number(std::log10(rhd)));
+                break;
+            case 's':
+                stack.push_back(ExprValue::number(std::sqrt(rhd)));
+                break;
+            case 'p':
+                stack.push_back(ExprValue::number(std::pow(rhd, 2)));
+                break;
+            case 'h':
+                stack.push_back(ExprValue::number(strtol(rhs.text().c_str(), nullptr, 16)));
+                break;
+            case 'x':
+                stack.push_back(ExprValue::from_text(to_hex(static_cast<int>(rhd))));
+                break;
+            case 'd':
+#ifndef EMSESP_STANDALONE
+                stack.push_back(ExprValue::number(rhd * esp_random() / UINT32_MAX));
+#else
+                stack.push_back(ExprValue::number(rhd * random()));
+#endif
+                break;
+            }
+        } break;
+        case Token::Type::Compare: {
+            if (stack.size() < 2) {
+                return "";
+            }
+            const auto rhs = std::move(stack.back());
+            stack.pop_back();
+            const auto lhs = std::move(stack.back());
+            stack.pop_back();
+            bool result;
+            if (lhs.is_num && rhs.is_num) {
+                switch (op.op) {
+                case '<':
+                    result = lhs.num < rhs.num;
+                    break;
+                case '{':
+                    result = lhs.num <= rhs.num;
+                    break;
+                case '>':
+                    result = lhs.num > rhs.num;
+                    break;
+                case '}':
+                    result = lhs.num >= rhs.num;
+                    break;
+                case '=':
+                    result = lhs.num == rhs.num;
+                    break;
+                case '!':
+                    result = lhs.num != rhs.num;
+                    break;
+                default:
+                    return "";
+                }
+            } else {
+                const auto l = lhs.text();
+                const auto r = rhs.text();
+                switch (op.op) {
+                case '<':
+                    result = l < r;
+                    break;
+                case '{':
+                    result = l <= r;
+                    break;
+                case '>':
+                    result = l > r;
+                    break;
+                case '}':
+                    result = l >= r;
+                    break;
+                case '=': // compare strings lower case
+                    result = emsesp::Helpers::toLower(l) == emsesp::Helpers::toLower(r);
+                    break;
+                case '!':
+                    result = emsesp::Helpers::toLower(l) != emsesp::Helpers::toLower(r);
+                    break;
+                default:
+                    return "";
+                }
+            }
+            stack.push_back(ExprValue::number(result ? 1 : 0));
+        } break;
+        case Token::Type::Logic: {
+            if (stack.size() < 2) {
+                return "";
+            }
+            const auto rhs = to_logic(stack.back().text());
+            stack.pop_back();
+            const auto lhs = to_logic(stack.back().text());
+            stack.pop_back();
+            if (rhs < 0 || lhs < 0) {
+                return "";
+            }
+            switch (op.op) {
+            case '&':
+                stack.push_back(ExprValue::number((lhs && rhs) ? 1 : 0));
+                break;
+            case '|':
+                stack.push_back(ExprValue::number((lhs || rhs) ? 1 : 0));
+                break;
+            default:
+                return "";
+            }
+        } break;
+        case Token::Type::Operator: {
+            if (stack.size() < 2) {
+                return "";
+            }
+            const auto rhs = std::move(stack.back());
+            stack.pop_back();
+            const auto lhs = std::move(stack.back());
+            stack.pop_back();
+            if (op.op == '+' && (!rhs.is_num || !lhs.is_num)) {
+                stack.push_back(ExprValue::from_text(lhs.text() + rhs.text()));
+                break;
+            }
+            double lhd, rhd;
+            if (!lhs.to_double(lhd) || !rhs.to_double(rhd)) {
+                return "";
+            }
+            switch (op.op) {
+            default:
+                return "";
+            case '^':
+                stack.push_back(ExprValue::number(pow(lhd, rhd)));
+                break;
+            case '*':
+                stack.push_back(ExprValue::number(lhd * rhd));
+                break;
+            case '/':
+                stack.push_back(ExprValue::number(lhd / rhd));
+                break;
+            case '%':
+                if (static_cast<int>(rhd) == 0) {
+                    return "";
+                }
+                stack.push_back(ExprValue::number(static_cast<int>(lhd) % static_cast<int>(rhd)));
+                break;
+            case '+':
+                stack.push_back(ExprValue::number(lhd + rhd));
+                break;
+            case '-':
+                stack.push_back(ExprValue::number(lhd - rhd));
+                break;
+            }
+        } break;
+        case Token::Type::LeftParen:
+        case Token::Type::RightParen:
+        case Token::Type::Unknown:
+        default:
+            return "";
+        }
+    }
+
+    // concatenate all elements in stack to a single string
+    std::string result = "";
+    for (const auto & v : stack) {
+        result += v.text();
+    }
+    return result;
+}
+
+// compiled expressions by their text, with url values left as marks, cleared when the schedules change
+// the scheduler task evaluates while the web server clears, so a program is shared and the map is locked
+static constexpr size_t EXPRESSION_CACHE_SIZE = 32;
+
+std::mutex & expression_cache_mutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+std::unordered_map<std::string, std::shared_ptr<const ExprProgram>> & expression_cache() {
+    static std::unordered_map<std::string, std::shared_ptr<const ExprProgram>> cache;
+    return cache;
+}
+
+void clear_expression_cache() {
+    std::lock_guard<std::mutex> lock(expression_cache_mutex());
+    expression_cache().clear();
+}
+
+// put the fetched values back into the text of an expression
+std::string insert_values(const std::string & expr, const std::vector<std::string> & values) {
+    std::string expr_new = expr;
+    auto        f        = expr_new.find(VALUE_MARK);
+    while (f != std::string::npos && f + 1 < expr_new.length()) {
+        size_t i = expr_new[f + 1] - 0x10;
+        expr_new.replace(f, 2, i < values.size() ? values[i] : "");
+        f = expr_new.find(VALUE_MARK, f);
+    }
+    return expr_new;
+}
+
+// calculate an expression, compiled on first use
+std::string calculate(const std::string & expr, const std::vector<std::string> & values = {}) {
+    std::shared_ptr<const ExprProgram> program;
+    {
+        std::lock_guard<std::mutex> lock(expression_cache_mutex());
+        auto                        it = expression_cache().find(expr);
+        if (it != expression_cache().end()) {
+            program = it->second;
+        }
+    }
+    if (!program) {
+        program = std::make_shared<const ExprProgram>(compile_expression(expr));
+        std::lock_guard<std::mutex> lock(expression_cache_mutex());
+        auto &                      cache = expression_cache();
+        if (cache.size() >= EXPRESSION_CACHE_SIZE) {
+            cache.clear();
+        }
+        cache.emplace(expr, program);
+    }
+    return program->compiled ? evaluate(*program, values) : calculate_text(insert_values(expr, values));
+}
+
 // check for multiple instances of <cond> ? <expr1> : <expr2>
 std::string compute(const std::string & expr) {
-    std::string expr_new = expr;
+    std::string              expr_new = expr;
+    std::vector<std::string> values; // numeric results of url requests
 
     // search json with url:
     auto f = expr_new.find_first_of('{');
@@ -738,7 +1247,13 @@ std::string compute(const std::string & expr) {
                     if (key.length() && DeserializationError::Ok == deserializeJson(doc, result)) {
                         result = doc[key.c_str()].as<std::string>();
                     }
-                    expr_new.replace(f, e - f, result.c_str());
+                    if (isnum(result) && values.size() < MAX_VALUES) {
+                        expr_new.replace(f, e - f, {VALUE_MARK, (char)(0x10 + values.size())});
+                        values.push_back(result);
+                        e = f + 2;
+                    } else {
+                        expr_new.replace(f, e - f, result.c_str());
+                    }
                 }
                 http.end();
             }
@@ -765,7 +1280,7 @@ std::string compute(const std::string & expr) {
             s--;
             br += (expr_new[s] == '(' ? -1 : expr_new[s] == ')' ? 1 : 0);
         }
-        std::string cond = calculate(expr_new.substr(s, q - s));
+        std::string cond = calculate(expr_new.substr(s, q - s), values);
         if (cond.length() == 0) {
             return "";
         } else if (cond[0] == '1') {
@@ -788,5 +1303,5 @@ std::string compute(const std::string & expr) {
         q = expr_new.find_first_of('?'); // search next instance
     }
 
-    return calculate(expr_new);
+    return calculate(expr_new, values);
 }
@@ -82,6 +82,7 @@ const char * const languages[] = {EMSESP_LOCALE_EN,
 #endif
 
 static constexpr uint8_t NUM_LANGUAGES = sizeof(languages) / sizeof(const char *);
+static_assert(NUM_LANGUAGES == EMSESP_LANGUAGES, "languages must match the translation slots in common.h");
 
 uuid::log::Logger System::logger_{F_(system), uuid::log::Facility::KERN};
 
@@ -91,11 +92,11 @@ bool     System::test_set_all_active_ = false;
 uint32_t System::max_alloc_mem_;
 uint32_t System::heap_mem_;
 
-// find the index of the language
+// find the index of the language, when the locale is set
 // 0 = EN, 1 = DE, etc...
-uint8_t System::language_index() {
+uint8_t System::find_language(const char * locale) {
     for (uint8_t i = 0; i < NUM_LANGUAGES; i++) {
-        if (languages[i] == locale()) {
+        if (!strcmp(languages[i], locale)) {
             return i;
         }
     }
@@ -303,10 +304,11 @@ void System::system_restart(const char * partitionname) {
     // make sure it's only executed once
     EMSESP::system_.systemStatus(SYSTEM_STATUS::SYSTEM_STATUS_NORMAL);
 
-    store_nvs_values(); // save any NVS values
-    Shell::loop_all();  // flush log to output
-    Mqtt::disconnect(); // gracefully disconnect MQTT, needed for QOS1
-    delay(1000);        // wait 1 second
+    store_nvs_values();            // save any NVS values
+    FSPersistenceBase::flushAll(); // write pending settings changes
+    Shell::loop_all();             // flush log to output
+    Mqtt::disconnect();            // gracefully disconnect MQTT, needed for QOS1
+    delay(1000);                   // wait 1 second
     ESP.restart();
 #else
     EMSESP::system_.systemStatus(SYSTEM_STATUS::SYSTEM_STATUS_NORMAL);
@@ -417,7 +419,7 @@ void System::reload_settings() {
         eth_phy_addr_   = settings.eth_phy_addr;
         eth_clock_mode_ = settings.eth_clock_mode;
 
-        locale_         = settings.locale;
+        locale(settings.locale);
         developer_mode_ = settings.developer_mode;
     });
 }
@@ -602,6 +604,8 @@ void System::loop() {
     system_check(); // check system health
     send_info_mqtt();
 #endif
+
+    FSPersistenceBase::loop(); // write changed settings after a quiet period
 }
 
 // send MQTT info topic appended with the version information as JSON, as a retained flag
@@ -737,6 +741,8 @@ void System::send_heartbeat() {
 
     heartbeat_json(json);
     Mqtt::queue_publish(F_(heartbeat), json); // send to MQTT with retain off. This will add to MQTT queue.
+
+    Profiler::publish(); // loop timings, only when the profiler is enabled
 }
 
 // initializes network
@@ -863,6 +869,8 @@ void System::commands_init() {
     Command::add(EMSdevice::DeviceType::SYSTEM, F_(format), System::command_format, FL_(format_cmd), CommandFlag::ADMIN_ONLY);
     Command::add(EMSdevice::DeviceType::SYSTEM, F_(watch), System::command_watch, FL_(watch_cmd));
     Command::add(EMSdevice::DeviceType::SYSTEM, F_(message), System::command_message, FL_(message_cmd));
+    Command::add(EMSdevice::DeviceType::SYSTEM, F_(perf), Profiler::command_perf, FL_(perf_cmd));
+    Command::add(EMSdevice::DeviceType::SYSTEM, F_(latency), Latency::command_latency, FL_(latency_cmd));
 #if defined(EMSESP_TEST)
     Command::add(EMSdevice::DeviceType::SYSTEM, ("test"), System::command_test, FL_(test_cmd));
 #endif
@@ -1570,6 +1578,15 @@ bool System::command_info(const char * value, const int8_t id, JsonObject output
     node["flash_chip_size"] = ESP.getFlashChipSize() / 1024;                   // kilobytes
 #endif
     node["resetReason"] = EMSESP::system_.reset_reason(0) + " / " + EMSESP::system_.reset_reason(1);
+#if defined(EMSESP_UNITY)
+    node["settingsWrites"]      = 0;
+    node["settingsWritesSaved"] = 0;
+    node["settingsMaxFlush"]    = 0;
+#else
+    node["settingsWrites"]      = FSPersistenceBase::writes();
+    node["settingsWritesSaved"] = FSPersistenceBase::writesSaved();  // updates merged into a later write
+    node["settingsMaxFlush"]    = FSPersistenceBase::maxFlushTime(); // ms
+#endif
 #ifndef EMSESP_STANDALONE
     node["psram"] = (EMSESP::system_.PSram() > 0); // make boolean
     if (EMSESP::system_.PSram()) {
@@ -1701,9 +1718,12 @@ bool System::command_info(const char * value, const int8_t id, JsonObject output
     // Sensor Status
     node = output["sensor"].to<JsonObject>();
     if (EMSESP::sensor_enabled()) {
-        node["temperatureSensors"]     = EMSESP::temperaturesensor_.count_entities();
-        node["temperatureSensorReads"] = EMSESP::temperaturesensor_.reads();
-        node["temperatureSensorFails"] = EMSESP::temperaturesensor_.fails();
+        node["temperatureSensors"]          = EMSESP::temperaturesensor_.count_entities();
+        node["temperatureSensorReads"]      = EMSESP::temperaturesensor_.reads();
+        node["temperatureSensorFails"]      = EMSESP::temperaturesensor_.fails();
+        node["temperatureSensorScans"]      = EMSESP::temperaturesensor_.scans();
+        node["temperatureSensorBusTime"]    = EMSESP::temperaturesensor_.bus_time(); // us per read cycle
+        node["temperatureSensorBusTimeMax"] = EMSESP::temperaturesensor_.bus_time_max();
     }
     if (EMSESP::analog_enabled()) {
         node["analogSensors"]     = EMSESP::analogsensor_.count_entities();
@@ -1748,6 +1768,15 @@ bool System::command_info(const char * value, const int8_t id, JsonObject output
     node["busWritesFailed"]        = EMSESP::txservice_.telegram_write_fail_count();
     node["busRxLineQuality"]       = EMSESP::rxservice_.quality();
     node["busTxLineQuality"]       = (EMSESP::txservice_.read_quality() + EMSESP::txservice_.read_quality()) / 2;
+    node["busTelegramPool"]        = TelegramPool::capacity();
+#if defined(EMSESP_UNITY)
+    node["busTelegramPoolMax"]      = 0;
+    node["busTelegramPoolOverflow"] = 0;
+#else
+    node["busTelegramPoolMax"]      = TelegramPool::high_water();
+    node["busTelegramPoolOverflow"] = TelegramPool::overflow_count();
+#endif
+    node["busRxRingOverflow"] = EMSESP::rxservice_.ring().overflow_count();
 
     // Settings
     node = output["settings"].to<JsonObject>();
@@ -1941,6 +1970,7 @@ bool System::load_board_profile(std::vector<int8_t> & data, const std::string &
 // format command - factory reset, removing all config files
 bool System::command_format(const char * value, const int8_t id) {
     LOG_INFO("Removing all config files");
+    FSPersistenceBase::flushAll(); // nothing pending that could write the files again
 #ifndef EMSESP_STANDALONE
     // TODO To replaced with LittleFS.rmdir(FS_CONFIG_DIRECTORY) now we're using IDF 4.2+
     File root = LittleFS.open(EMSESP_FS_CONFIG_DIRECTORY);
@@ -2134,6 +2164,7 @@ bool System::uploadFirmwareURL(const char * url) {
     // check we have enough space for the upload in the ota partition
     int firmware_size = http.getSize();
     LOG_INFO("Firmware uploading (size: %d bytes). Please wait...", firmware_size);
+    FSPersistenceBase::flushAll(); // write pending settings changes before the restart
     if (!Update.begin(firmware_size)) {
         LOG_ERROR("Firmware upload failed - no space");
         http.end();
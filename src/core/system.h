@@ -269,10 +269,14 @@ class System {
         return fahrenheit_;
     }
 
-    uint8_t language_index();
+    // the index of the locale in the translation lists, 0 = EN
+    uint8_t language_index() const {
+        return language_index_;
+    }
 
     void locale(String locale) {
-        locale_ = locale;
+        locale_         = locale;
+        language_index_ = find_language(locale_.c_str());
     }
 
     std::string locale() {
@@ -345,6 +349,8 @@ class System {
 
     uint8_t systemStatus_; // uses SYSTEM_STATUS enum
 
+    static uint8_t find_language(const char * locale);
+
     // button
     static PButton            myPButton_; // PButton instance
     static void               button_OnClick(PButton & b);
@@ -393,6 +399,7 @@ class System {
     // copies from WebSettings class in WebSettingsService.h and loaded with reload_settings()
     std::string hostname_;
     String      locale_;
+    uint8_t     language_index_ = 0;
     bool        hide_led_;
     uint8_t     led_type_;
     uint8_t     led_gpio_;
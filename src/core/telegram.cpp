@@ -36,6 +36,47 @@ const uint8_t ems_crc_table[] = {0x00, 0x02, 0x04, 0x06, 0x08, 0x0A, 0x0C, 0x0E,
                                  0xA1, 0xA3, 0xA5, 0xA7, 0xD9, 0xDB, 0xDD, 0xDF, 0xD1, 0xD3, 0xD5, 0xD7, 0xC9, 0xCB, 0xCD, 0xCF, 0xC1, 0xC3, 0xC5, 0xC7,
                                  0xF9, 0xFB, 0xFD, 0xFF, 0xF1, 0xF3, 0xF5, 0xF7, 0xE9, 0xEB, 0xED, 0xEF, 0xE1, 0xE3, 0xE5, 0xE7};
 
+TelegramPool::Block   TelegramPool::blocks_[TelegramPool::POOL_SIZE];
+TelegramPool::Block * TelegramPool::free_list_      = nullptr;
+uint16_t              TelegramPool::next_unused_    = 0;
+uint16_t              TelegramPool::in_use_         = 0;
+uint16_t              TelegramPool::high_water_     = 0;
+uint32_t              TelegramPool::overflow_count_ = 0;
+std::mutex            TelegramPool::mutex_;
+
+void * TelegramPool::allocate(size_t size) {
+    if (size <= BLOCK_SIZE) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Block *                     block = nullptr;
+        if (free_list_) {
+            block      = free_list_;
+            free_list_ = block->next;
+        } else if (next_unused_ < POOL_SIZE) {
+            block = &blocks_[next_unused_++];
+        }
+        if (block) {
+            if (++in_use_ > high_water_) {
+                high_water_ = in_use_;
+            }
+            return block->data;
+        }
+        overflow_count_++;
+    }
+    return ::operator new(size);
+}
+
+void TelegramPool::deallocate(void * p) {
+    auto block = static_cast<Block *>(p);
+    if (block >= blocks_ && block < blocks_ + POOL_SIZE) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        block->next = free_list_;
+        free_list_  = block;
+        in_use_--;
+        return;
+    }
+    ::operator delete(p);
+}
+
 uint32_t EMSbus::last_bus_activity_ = 0;              // timestamp of last time a valid Rx came in
 uint32_t EMSbus::bus_uptime_start_  = 0;              // timestamp of when the bus was started
 bool     EMSbus::bus_connected_     = false;          // start assuming the bus hasn't been connected
@@ -126,13 +167,69 @@ std::string Telegram::to_string_message() const {
     return Helpers::data_to_hex(this->message_data, this->message_length);
 }
 
+// adds a received frame, dropped and counted when the ring is full
+bool RxFrameRing::push(const uint8_t * data, const uint8_t length, const uint32_t timestamp) {
+    uint16_t head = head_.load(std::memory_order_relaxed);
+    uint16_t used = head - tail_.load(std::memory_order_acquire);
+    if (used >= SIZE || length > sizeof(frames_[0].data)) {
+        overflow_count_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    Frame & frame    = frames_[head & (SIZE - 1)];
+    frame.timestamp  = timestamp;
+    frame.length     = length;
+    memcpy(frame.data, data, length);
+    head_.store(head + 1, std::memory_order_release); // publish the frame
+    if (used + 1 > high_water_.load(std::memory_order_relaxed)) {
+        high_water_.store(used + 1, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+const RxFrameRing::Frame * RxFrameRing::front() const {
+    uint16_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == head_.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+    return &frames_[tail & (SIZE - 1)];
+}
+
+void RxFrameRing::pop() {
+    tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release); // release the slot
+}
+
+// called from the UART receive task, only copies the frame to the ring
+void RxService::receive(const uint8_t * data, const uint8_t length) {
+    rx_ring_.push(data, length, Latency::now());
+}
+
 // checks if we have an Rx telegram that needs processing
 void RxService::loop() {
+    Latency::loop(); // collect the Tx round trips
+
+    // move the frames received by the UART task to the Rx queue
+    uint32_t now = Latency::now();
+    while (auto frame = rx_ring_.front()) {
+        uint32_t wait = now - frame->timestamp;
+        Latency::add(Latency::RING, frame->timestamp);
+        if (wait / 1000 > rx_ring_latency_max_) {
+            rx_ring_latency_max_ = wait / 1000;
+        }
+        uint8_t data[sizeof(frame->data)];
+        memcpy(data, frame->data, frame->length);
+        add(data, frame->length, frame->timestamp);
+        rx_ring_.pop();
+    }
+
     while (!rx_telegrams_.empty()) {
-        auto telegram = rx_telegrams_.front().telegram_;
-        (void)EMSESP::process_telegram(telegram); // further process the telegram
-        increment_telegram_count();               // increase rx count
-        rx_telegrams_.pop_front();                // remove it from the queue
+        auto     telegram = rx_telegrams_.front().telegram_;
+        uint32_t start    = Latency::now();
+        Latency::telegram(rx_telegrams_.front().received_); // publishes from here on are measured against the reception
+        (void)EMSESP::process_telegram(telegram);           // further process the telegram
+        Latency::telegram(0);
+        Latency::add(Latency::HANDLER, start);
+        increment_telegram_count(); // increase rx count
+        rx_telegrams_.pop_front();  // remove it from the queue
     }
 }
 
@@ -140,7 +237,7 @@ void RxService::loop() {
 // data is the whole telegram, assuming last byte holds the CRC
 // length includes the CRC
 // for EMS+ the type_id has the value + 256. We look for these type of telegrams with F7, F9 and FF in 3rd byte
-void RxService::add(uint8_t * data, uint8_t length) {
+void RxService::add(uint8_t * data, uint8_t length, const uint32_t received) {
     if (length < 5) {
         return;
     }
@@ -226,19 +323,19 @@ void RxService::add(uint8_t * data, uint8_t length) {
     }
 
     // create the telegram
-    auto telegram = std::make_shared<Telegram>(operation, src, dest, type_id, offset, message_data, message_length);
+    auto telegram = TelegramPool::make_telegram(operation, src, dest, type_id, offset, message_data, message_length);
 
     // check if queue is full, if so remove top item to make space
     if (rx_telegrams_.size() >= MAX_RX_TELEGRAMS) {
         rx_telegrams_.pop_front();
     }
 
-    rx_telegrams_.emplace_back(rx_telegram_id_++, std::move(telegram)); // add to queue
+    rx_telegrams_.emplace_back(rx_telegram_id_++, std::move(telegram), received); // add to queue
 }
 
 // add empty telegram to rx-queue
 void RxService::add_empty(const uint8_t src, const uint8_t dest, const uint16_t type_id, uint8_t offset) {
-    auto telegram = std::make_shared<Telegram>(Telegram::Operation::RX, src, dest, type_id, offset, nullptr, 0);
+    auto telegram = TelegramPool::make_telegram(Telegram::Operation::RX, src, dest, type_id, offset, nullptr, 0);
     // only if queue is  not full
     if (rx_telegrams_.size() < MAX_RX_TELEGRAMS) {
         rx_telegrams_.emplace_back(rx_telegram_id_++, std::move(telegram)); // add to queue
@@ -275,6 +372,8 @@ void TxService::send_poll() const {
 // get src id from next telegram to check poll in emsesp::incoming_telegram
 uint8_t TxService::get_send_id() {
     static uint32_t count = 0;
+
+    std::lock_guard<std::recursive_mutex> lock(tx_mutex_);
     if (!tx_telegrams_.empty() && tx_telegrams_.front().telegram_->src != ems_bus_id()) {
         if (++count > 500) { // after 500 polls (~3-10 sec) there will be no master poll for this id
             tx_telegrams_.pop_front();
@@ -295,6 +394,8 @@ void TxService::send() {
         return;
     }
 
+    std::lock_guard<std::recursive_mutex> lock(tx_mutex_);
+
     // if there's nothing in the queue to transmit or sending should be delayed, send back a poll and quit
     if (tx_telegrams_.empty() || (delayed_send_ && uuid::get_uptime() < delayed_send_)) {
         send_poll();
@@ -304,7 +405,14 @@ void TxService::send() {
 
     // if we're in read-only mode (tx_mode 0) forget the Tx call
     if (tx_mode() != 0) {
-        send_telegram(tx_telegrams_.front());
+        const auto & tx_telegram = tx_telegrams_.front();
+        send_telegram(tx_telegram);
+
+        auto &   stats = lane_stats_[tx_telegram.lane_];
+        uint32_t wait  = uuid::get_uptime() - tx_telegram.queued_;
+        stats.sent++;
+        stats.wait_total += wait;
+        stats.wait_max = std::max(stats.wait_max, wait);
     }
 
     tx_telegrams_.pop_front(); // remove the telegram from the queue
@@ -379,7 +487,7 @@ void TxService::send_telegram(const QueuedTxTelegram & tx_telegram) {
         }
     }
     // make a copy of the telegram with new dest (without read-flag)
-    telegram_last_ = std::make_shared<Telegram>(
+    telegram_last_ = TelegramPool::make_telegram(
         telegram->operation, telegram->src, dest & 0x7F, telegram->type_id, telegram->offset, telegram->message_data, telegram->message_length);
 
     uint8_t length       = message_p;
@@ -404,6 +512,7 @@ void TxService::send_telegram(const QueuedTxTelegram & tx_telegram) {
     // this is the core send command to the UART
     //
     uint16_t status = EMSuart::transmit(telegram_raw, length);
+    Latency::tx_sent();
 
     if (status == EMS_TX_STATUS_ERR) {
         LOG_ERROR("Failed to transmit Tx via UART.");
@@ -438,29 +547,134 @@ void TxService::add(const uint8_t  operation,
                     const uint8_t  message_length,
                     const uint16_t validateid,
                     const bool     front) {
-    auto telegram = std::make_shared<Telegram>(operation, ems_bus_id(), dest, type_id, offset, message_data, message_length);
+    uint8_t lane = tx_lane(operation, front);
 
-    LOG_DEBUG("New Tx [#%d] telegram, length %d", tx_telegram_id_, message_length);
+    {
+        std::lock_guard<std::recursive_mutex> lock(tx_mutex_);
+        if (!merge(operation, dest, type_id, offset, message_data, message_length, validateid, lane)) {
+            auto telegram = TelegramPool::make_telegram(operation, ems_bus_id(), dest, type_id, offset, message_data, message_length);
 
-    // if the queue is full, make room by removing the last one
-    if (tx_telegrams_.size() >= MAX_TX_TELEGRAMS) {
-        LOG_WARNING("Tx queue overflow, skip one message");
-        if (tx_telegrams_.front().telegram_->operation == Telegram::Operation::TX_WRITE) {
-            telegram_write_fail_count_++;
-        } else {
-            telegram_read_fail_count_++;
+            LOG_DEBUG("New Tx [#%d] telegram, length %d", tx_telegram_id_, message_length);
+
+            if (!make_room(operation, lane)) {
+                return;
+            }
+            enqueue(std::move(telegram), lane, validateid, front);
         }
-        tx_telegrams_.pop_front();
     }
 
+    if (validateid != 0) {
+        EMSESP::wait_validate(validateid);
+    }
+}
+
+// adds a telegram at the head or the tail of its lane, called with tx_mutex_ held
+void TxService::enqueue(std::shared_ptr<const Telegram> telegram, const uint8_t lane, const uint16_t validateid, const bool front) {
+    auto it = tx_telegrams_.end();
     if (front) {
-        tx_telegrams_.emplace_front(tx_telegram_id_++, std::move(telegram), false, validateid); // add to front of queue
+        it = tx_telegrams_.begin();
+        while (it != tx_telegrams_.end() && it->lane_ < lane) {
+            ++it;
+        }
     } else {
-        tx_telegrams_.emplace_back(tx_telegram_id_++, std::move(telegram), false, validateid); // add to back of queue
+        while (it != tx_telegrams_.begin() && std::prev(it)->lane_ > lane) {
+            --it;
+        }
     }
-    if (validateid != 0) {
-        EMSESP::wait_validate(validateid);
+    tx_telegrams_.emplace(it, tx_telegram_id_++, std::move(telegram), false, validateid, lane, uuid::get_uptime());
+}
+
+// if the queue is full, make room by removing the last one, unless everything waiting is more important
+// returns false if there is no room for the new telegram, called with tx_mutex_ held
+bool TxService::make_room(const uint8_t operation, const uint8_t lane) {
+    if (tx_telegrams_.size() < MAX_TX_TELEGRAMS) {
+        return true;
+    }
+
+    LOG_WARNING("Tx queue overflow, skip one message");
+    bool    room    = tx_telegrams_.back().lane_ >= lane;
+    uint8_t skipped = room ? tx_telegrams_.back().telegram_->operation : operation;
+    if (skipped == Telegram::Operation::TX_WRITE) {
+        telegram_write_fail_count_++;
+    } else {
+        telegram_read_fail_count_++;
+    }
+    if (room) {
+        tx_telegrams_.pop_back();
+    }
+    return room;
+}
+
+// merges a read or write into a pending telegram to the same device and type
+// a read of the same offset is only queued once, with the longest length and the higher lane
+// writes with touching or overlapping ranges become one write, the newer values win
+// returns true if the telegram was merged, called with tx_mutex_ held
+bool TxService::merge(const uint8_t   operation,
+                      const uint8_t   dest,
+                      const uint16_t  type_id,
+                      const uint8_t   offset,
+                      const uint8_t * message_data,
+                      const uint8_t   message_length,
+                      const uint16_t  validateid,
+                      const uint8_t   lane) {
+    if ((operation != Telegram::Operation::TX_READ && operation != Telegram::Operation::TX_WRITE) || !message_length) {
+        return false;
+    }
+
+    for (auto it = tx_telegrams_.begin(); it != tx_telegrams_.end(); ++it) {
+        auto pending = it->telegram_;
+        if (it->retry_ || pending->operation != operation || pending->src != ems_bus_id() || pending->dest != dest || pending->type_id != type_id) {
+            continue;
+        }
+
+        if (operation == Telegram::Operation::TX_READ) {
+            if (pending->offset != offset || it->validateid_) {
+                continue;
+            }
+            uint8_t length = std::max(pending->message_data[0], message_data[0]);
+            LOG_DEBUG("Tx read merged with pending Tx [#%d]", it->id_);
+            if (it->lane_ <= lane) {
+                if (length != pending->message_data[0]) {
+                    it->telegram_ = TelegramPool::make_telegram(operation, ems_bus_id(), dest, type_id, offset, &length, 1);
+                }
+            } else {
+                tx_telegrams_.erase(it); // move it up to the new lane
+                enqueue(TelegramPool::make_telegram(operation, ems_bus_id(), dest, type_id, offset, &length, 1), lane, 0, false);
+            }
+            merged_count_++;
+            return true;
+        }
+
+        uint16_t pending_end = pending->offset + pending->message_length;
+        uint16_t end         = offset + message_length;
+        if (offset > pending_end || pending->offset > end || (validateid && it->validateid_ && validateid != it->validateid_)) {
+            continue;
+        }
+        uint8_t  start = std::min(offset, pending->offset);
+        uint16_t stop  = std::max(end, pending_end);
+        if (stop - start > (type_id > 0xFF ? EMS_MAX_TELEGRAM_MESSAGE_LENGTH - 2 : EMS_MAX_TELEGRAM_MESSAGE_LENGTH)) {
+            continue; // would not fit in one telegram
+        }
+
+        uint8_t data[EMS_MAX_TELEGRAM_MESSAGE_LENGTH];
+        memcpy(data + pending->offset - start, pending->message_data, pending->message_length);
+        memcpy(data + offset - start, message_data, message_length);
+
+        LOG_DEBUG("Tx write merged with pending Tx [#%d]", it->id_);
+        it->telegram_ = TelegramPool::make_telegram(operation, ems_bus_id(), dest, type_id, start, data, stop - start);
+        if (validateid) {
+            it->validateid_ = validateid;
+        }
+        merged_count_++;
+        return true;
     }
+
+    return false;
+}
+
+uint8_t TxService::lane_depth(const uint8_t lane) const {
+    std::lock_guard<std::recursive_mutex> lock(tx_mutex_);
+    return std::count_if(tx_telegrams_.begin(), tx_telegrams_.end(), [lane](const QueuedTxTelegram & tx_telegram) { return tx_telegram.lane_ == lane; });
 }
 
 // builds a Tx telegram and adds to queue
@@ -519,25 +733,18 @@ void TxService::add(uint8_t operation, const uint8_t * data, const uint8_t lengt
         }
     }
 
-    auto telegram = std::make_shared<Telegram>(operation, src, dest, type_id, offset, message_data, message_length); // operation is TX_WRITE or TX_READ
+    auto telegram = TelegramPool::make_telegram(operation, src, dest, type_id, offset, message_data, message_length); // operation is TX_WRITE or TX_READ
 
-    // if the queue is full, make room by removing the last one
-    if (tx_telegrams_.size() >= MAX_TX_TELEGRAMS) {
-        LOG_WARNING("Tx queue overflow, skip one message");
-        if (tx_telegrams_.front().telegram_->operation == Telegram::Operation::TX_WRITE) {
-            telegram_write_fail_count_++;
-        } else {
-            telegram_read_fail_count_++;
+    uint8_t lane = tx_lane(operation, front);
+    {
+        std::lock_guard<std::recursive_mutex> lock(tx_mutex_);
+        if (!make_room(operation, lane)) {
+            return;
         }
-        tx_telegrams_.pop_front();
-    }
 
-    LOG_DEBUG("New Tx [#%d] telegram, length %d", tx_telegram_id_, message_length);
+        LOG_DEBUG("New Tx [#%d] telegram, length %d", tx_telegram_id_, message_length);
 
-    if (front && (operation != Telegram::Operation::TX_RAW || EMSESP::response_id() == 0)) {
-        tx_telegrams_.emplace_front(tx_telegram_id_++, std::move(telegram), false, validate_id); // add to front of queue
-    } else {
-        tx_telegrams_.emplace_back(tx_telegram_id_++, std::move(telegram), false, validate_id); // add to back of queue
+        enqueue(std::move(telegram), lane, validate_id, front && (operation != Telegram::Operation::TX_RAW || EMSESP::response_id() == 0));
     }
     if (validate_id != 0) {
         EMSESP::wait_validate(validate_id);
@@ -623,6 +830,7 @@ void TxService::retry_tx(const uint8_t operation, const uint8_t * data, const ui
               Helpers::data_to_hex(data, length - 1).c_str());
 
     // add to the top of the queue
+    std::lock_guard<std::recursive_mutex> lock(tx_mutex_);
     if (tx_telegrams_.size() >= MAX_TX_TELEGRAMS) {
         LOG_WARNING("Tx queue overflow, skip retry");
         reset_retry_count();      // give up
@@ -630,7 +838,9 @@ void TxService::retry_tx(const uint8_t operation, const uint8_t * data, const ui
         return;
     }
 
-    tx_telegrams_.emplace_front(tx_telegram_id_++, std::move(telegram_last_), true, get_post_send_query());
+    // a retry goes before everything else, the bus transaction is still ongoing
+    tx_telegrams_.emplace_front(
+        tx_telegram_id_++, std::move(telegram_last_), true, get_post_send_query(), tx_lane(operation, true), uuid::get_uptime());
 }
 
 // send a request to read the next block of data from longer telegrams
@@ -653,7 +863,15 @@ uint16_t TxService::read_next_tx(const uint8_t offset, const uint8_t length) {
         return 0;
     }
     if (offset >= telegram_last_->offset && old_length > 0 && next_length > 0) {
-        add(Telegram::Operation::TX_READ, telegram_last_->dest, telegram_last_->type_id, next_offset, &next_length, 1, 0, true);
+        // the next part is sent right away, before everything else in the queue
+        auto telegram = TelegramPool::make_telegram(
+            Telegram::Operation::TX_READ, ems_bus_id(), telegram_last_->dest, telegram_last_->type_id, next_offset, &next_length, 1);
+        LOG_DEBUG("New Tx [#%d] telegram, length %d", tx_telegram_id_, 1);
+        std::lock_guard<std::recursive_mutex> lock(tx_mutex_);
+        if (!make_room(Telegram::Operation::TX_READ, TX_LANE_VALIDATE)) {
+            return 0;
+        }
+        tx_telegrams_.emplace_front(tx_telegram_id_++, std::move(telegram), false, 0, TX_LANE_VALIDATE, uuid::get_uptime());
         return telegram_last_->type_id;
     }
     return 0;
@@ -21,6 +21,9 @@
 
 #include <string>
 #include <deque>
+#include <memory>
+#include <mutex>
+#include <atomic>
 #include <uuid/log.h>
 
 // UART drivers
@@ -159,6 +162,80 @@ class Telegram {
     int8_t _getDataPosition(const uint8_t index, const uint8_t size) const;
 };
 
+// fixed size pool holding the Telegrams of the Rx and Tx queues, to avoid a heap allocation per telegram
+// telegrams are created with std::allocate_shared so the handlers still get a std::shared_ptr<const Telegram>
+// if the pool is exhausted it falls back to the heap and counts an overflow
+class TelegramPool {
+  public:
+    template <typename... Args>
+    static std::shared_ptr<Telegram> make_telegram(Args &&... args) {
+        return std::allocate_shared<Telegram>(Allocator<Telegram>(), std::forward<Args>(args)...);
+    }
+
+    static uint16_t capacity() {
+        return POOL_SIZE;
+    }
+
+    static uint16_t in_use() {
+        return in_use_;
+    }
+
+    static uint16_t high_water() {
+        return high_water_;
+    }
+
+    static uint32_t overflow_count() {
+        return overflow_count_;
+    }
+
+    template <typename T>
+    struct Allocator {
+        using value_type = T;
+
+        Allocator() = default;
+        template <typename U>
+        Allocator(const Allocator<U> &) {
+        }
+
+        T * allocate(size_t n) {
+            return static_cast<T *>(TelegramPool::allocate(n * sizeof(T)));
+        }
+        void deallocate(T * p, size_t) {
+            TelegramPool::deallocate(p);
+        }
+
+        template <typename U>
+        bool operator==(const Allocator<U> &) const {
+            return true;
+        }
+        template <typename U>
+        bool operator!=(const Allocator<U> &) const {
+            return false;
+        }
+    };
+
+  private:
+    // Telegram plus the shared_ptr control block, and a few spare for telegrams in use outside the queues (last Tx, the one being processed)
+    static constexpr size_t   BLOCK_SIZE = (sizeof(Telegram) + 4 * sizeof(void *) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+    static constexpr uint16_t POOL_SIZE  = MAX_RX_TELEGRAMS + MAX_TX_TELEGRAMS + 4;
+
+    union Block {
+        Block * next;
+        alignas(std::max_align_t) uint8_t data[BLOCK_SIZE];
+    };
+
+    static void * allocate(size_t size);
+    static void   deallocate(void * p);
+
+    static Block      blocks_[POOL_SIZE];
+    static Block *    free_list_;      // released blocks
+    static uint16_t   next_unused_;    // blocks never used yet
+    static uint16_t   in_use_;         // # blocks currently allocated
+    static uint16_t   high_water_;     // max # blocks allocated at the same time
+    static uint32_t   overflow_count_; // # telegrams allocated from the heap because the pool was full
+    static std::mutex mutex_;          // Rx telegrams are added from the UART task
+};
+
 class EMSbus {
   public:
     static uuid::log::Logger logger_;
@@ -249,13 +326,54 @@ class EMSbus {
     static uint8_t  tx_state_;          // state of the Tx line (NONE or waiting on a TX_READ or TX_WRITE)
 };
 
+// lock-free single producer, single consumer ring of raw frames
+// carries the telegrams from the UART receive task to the main loop
+// the producer only writes head_, the consumer only writes tail_
+class RxFrameRing {
+  public:
+    static constexpr uint8_t SIZE = 32; // must be a power of 2
+
+    struct Frame {
+        uint32_t timestamp; // us when received, Latency::now()
+        uint8_t  length;
+        uint8_t  data[EMS_MAX_TELEGRAM_LENGTH + 1];
+    };
+
+    // producer side
+    bool push(const uint8_t * data, const uint8_t length, const uint32_t timestamp);
+
+    // consumer side, front() is valid until pop()
+    const Frame * front() const;
+    void          pop();
+
+    uint8_t size() const {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+
+    uint8_t high_water() const {
+        return high_water_.load(std::memory_order_relaxed);
+    }
+
+    uint32_t overflow_count() const {
+        return overflow_count_.load(std::memory_order_relaxed);
+    }
+
+  private:
+    Frame                 frames_[SIZE];
+    std::atomic<uint16_t> head_{0}; // free running, masked on access
+    std::atomic<uint16_t> tail_{0};
+    std::atomic<uint32_t> overflow_count_{0};
+    std::atomic<uint8_t>  high_water_{0};
+};
+
 class RxService : public EMSbus {
   public:
     RxService()  = default;
     ~RxService() = default;
 
     void loop();
-    void add(uint8_t * data, uint8_t length);
+    void add(uint8_t * data, uint8_t length, const uint32_t received = 0);
+    void receive(const uint8_t * data, const uint8_t length);
     void add_empty(const uint8_t src, const uint8_t dst, const uint16_t type_id, uint8_t offset);
 
     uint32_t telegram_count() const {
@@ -283,12 +401,14 @@ class RxService : public EMSbus {
       public:
         const uint16_t                        id_;
         const std::shared_ptr<const Telegram> telegram_;
+        const uint32_t                        received_; // us when received by the UART, 0 if not from the bus
 
         ~QueuedRxTelegram() = default;
         // removed && from telegram in 3.7.0-dev.43
-        QueuedRxTelegram(uint16_t id, std::shared_ptr<Telegram> telegram)
+        QueuedRxTelegram(uint16_t id, std::shared_ptr<Telegram> telegram, uint32_t received = 0)
             : id_(id)
-            , telegram_(std::move(telegram)) {
+            , telegram_(std::move(telegram))
+            , received_(received) {
         }
     };
 
@@ -296,6 +416,14 @@ class RxService : public EMSbus {
         return rx_telegrams_;
     }
 
+    const RxFrameRing & ring() const {
+        return rx_ring_;
+    }
+
+    uint32_t ring_latency_max() const {
+        return rx_ring_latency_max_;
+    }
+
   private:
     static constexpr uint8_t EMS_BUS_QUALITY_RX_THRESHOLD = 5; // % threshold before reporting quality issues
 
@@ -304,6 +432,8 @@ class RxService : public EMSbus {
     uint32_t                        telegram_error_count_ = 0; // # Rx CRC errors
     std::shared_ptr<const Telegram> rx_telegram;               // the incoming Rx telegram
     std::deque<QueuedRxTelegram>    rx_telegrams_;             // the Rx Queue
+    RxFrameRing                     rx_ring_;                  // raw frames from the UART task
+    uint32_t                        rx_ring_latency_max_ = 0;  // ms, longest wait of a frame in the ring
 };
 
 class TxService : public EMSbus {
@@ -311,6 +441,20 @@ class TxService : public EMSbus {
     static constexpr uint8_t TX_WRITE_FAIL    = 4; // EMS return code for fail
     static constexpr uint8_t TX_WRITE_SUCCESS = 1; // EMS return code for success
 
+    // priority lanes of the Tx queue, a lower lane is always sent first
+    enum TxLane : uint8_t {
+        TX_LANE_WRITE = 0, // writes and raw telegrams from commands
+        TX_LANE_VALIDATE,  // reads sent to the front, e.g. read back after a write or a read command
+        TX_LANE_FETCH,     // scheduled fetches and all other reads
+        TX_LANES
+    };
+
+    struct TxLaneStats {
+        uint32_t sent       = 0;
+        uint32_t wait_max   = 0; // ms
+        uint64_t wait_total = 0; // ms
+    };
+
     TxService()  = default;
     ~TxService() = default;
 
@@ -409,34 +553,51 @@ class TxService : public EMSbus {
     }
 
     struct QueuedTxTelegram {
-        const uint16_t                        id_;
-        const std::shared_ptr<const Telegram> telegram_;
-        const bool                            retry_; // true if its a retry
-        const uint16_t                        validateid_;
+        uint16_t                        id_;
+        std::shared_ptr<const Telegram> telegram_;
+        bool                            retry_; // true if its a retry
+        uint16_t                        validateid_;
+        uint8_t                         lane_;   // TxLane
+        uint32_t                        queued_; // uptime when added, in ms
 
         ~QueuedTxTelegram() = default;
         // replaced && im std::shared_ptr<Telegram> telegram in 3.7.0-dev.43
-        QueuedTxTelegram(uint16_t id, std::shared_ptr<Telegram> telegram, bool retry, uint16_t validateid)
+        QueuedTxTelegram(uint16_t id, std::shared_ptr<const Telegram> telegram, bool retry, uint16_t validateid, uint8_t lane, uint32_t queued)
             : id_(id)
             , telegram_(std::move(telegram))
             , retry_(retry)
-            , validateid_(validateid) {
+            , validateid_(validateid)
+            , lane_(lane)
+            , queued_(queued) {
         }
     };
 
     std::deque<QueuedTxTelegram> queue() const {
+        std::lock_guard<std::recursive_mutex> lock(tx_mutex_);
         return tx_telegrams_;
     }
 
     bool tx_queue_empty() const {
+        std::lock_guard<std::recursive_mutex> lock(tx_mutex_);
         return tx_telegrams_.empty();
     }
 
+    uint8_t lane_depth(const uint8_t lane) const;
+
+    const TxLaneStats & lane_stats(const uint8_t lane) const {
+        return lane_stats_[lane];
+    }
+
+    uint32_t merged_count() const {
+        return merged_count_;
+    }
+
     static constexpr uint8_t  MAXIMUM_TX_RETRIES = 3;
     static constexpr uint32_t POST_SEND_DELAY    = 2000;
 
   private:
     std::deque<QueuedTxTelegram> tx_telegrams_; // the Tx queue
+    mutable std::recursive_mutex tx_mutex_;     // guards tx_telegrams_ for the loop and the UART task, recursive as the transmit in send() may read the queue
 
     uint32_t telegram_read_count_       = 0; // # Tx successful reads
     uint32_t telegram_write_count_      = 0; // # Tx successful writes
@@ -450,7 +611,27 @@ class TxService : public EMSbus {
 
     uint8_t tx_telegram_id_ = 0; // queue counter
 
+    TxLaneStats lane_stats_[TX_LANES];
+    uint32_t    merged_count_ = 0; // # reads and writes merged into a pending telegram
+
     void send_telegram(const QueuedTxTelegram & tx_telegram);
+    void enqueue(std::shared_ptr<const Telegram> telegram, const uint8_t lane, const uint16_t validateid, const bool front);
+    bool merge(const uint8_t   operation,
+               const uint8_t   dest,
+               const uint16_t  type_id,
+               const uint8_t   offset,
+               const uint8_t * message_data,
+               const uint8_t   message_length,
+               const uint16_t  validateid,
+               const uint8_t   lane);
+    bool make_room(const uint8_t operation, const uint8_t lane);
+
+    static uint8_t tx_lane(const uint8_t operation, const bool front) {
+        if (operation == Telegram::Operation::TX_READ) {
+            return front ? TX_LANE_VALIDATE : TX_LANE_FETCH;
+        }
+        return TX_LANE_WRITE;
+    }
 };
 
 } // namespace emsesp
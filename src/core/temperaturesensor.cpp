@@ -66,6 +66,8 @@ void TemperatureSensor::reload() {
     }
 }
 
+// each cycle starts a conversion on all sensors and then reads the known sensors by their ROM code, one per loop
+// the bus is searched for new or returning sensors at startup, every RESCAN_MS and after a failed read
 void TemperatureSensor::loop() {
     if (!dallas_gpio_) {
         return; // dallas gpio is 0 (disabled)
@@ -74,44 +76,56 @@ void TemperatureSensor::loop() {
 #ifndef EMSESP_STANDALONE
     uint32_t time_now = uuid::get_uptime();
 
+    if (state_ == State::IDLE && time_now - last_activity_ < READ_INTERVAL_MS) {
+        return;
+    }
+
+    uint32_t bus_start = micros();
+
     if (state_ == State::IDLE) {
-        if (time_now - last_activity_ >= READ_INTERVAL_MS) {
 #ifdef EMSESP_DEBUG_SENSOR
-            LOG_DEBUG("Read sensor temperature");
+        LOG_DEBUG("Read sensor temperature");
 #endif
-            if (bus_.reset() || parasite_) {
-                YIELD;
-                bus_.skip();
-                bus_.write(CMD_CONVERT_TEMP, parasite_ ? 1 : 0);
-                state_     = State::READING;
-                scanretry_ = 0;
-            } else {
-                // no sensors found
-                if (sensors_.size()) {
-                    sensorfails_++;
-                    if (++scanretry_ > SCAN_MAX) { // every 30 sec
-                        scanretry_ = 0;
+        if (bus_.reset() || parasite_) {
+            YIELD;
+            bus_.skip();
+            bus_.write(CMD_CONVERT_TEMP, parasite_ ? 1 : 0);
+            state_     = State::READING;
+            scanretry_ = 0;
+        } else {
+            // no sensors found
+            if (sensors_.size()) {
+                sensorfails_++;
+                if (++scanretry_ > SCAN_MAX) { // every 30 sec
+                    scanretry_ = 0;
 #ifdef EMSESP_DEBUG_SENSOR
-                        LOG_DEBUG("Error: Bus reset failed");
+                    LOG_DEBUG("Error: Bus reset failed");
 #endif
 #ifndef EMSESP_TEST
-                        // don't reset if running in test mode where we simulate sensors
-                        for (auto & sensor : sensors_) {
-                            sensor.temperature_c = EMS_VALUE_INT16_NOTSET;
-                        }
-#endif
+                    // don't reset if running in test mode where we simulate sensors
+                    for (auto & sensor : sensors_) {
+                        sensor.temperature_c = EMS_VALUE_INT16_NOTSET;
                     }
+#endif
                 }
             }
-            last_activity_ = time_now;
         }
+        last_activity_ = time_now;
     } else if (state_ == State::READING) {
         if (temperature_convert_complete() && (time_now - last_activity_ > CONVERSION_MS)) {
+            if (scancnt_ <= 0 || rescan_ || sensors_.empty() || time_now - last_scan_ >= RESCAN_MS) {
 #ifdef EMSESP_DEBUG_SENSOR
-            LOG_DEBUG("Scanning for temperature sensors");
+                LOG_DEBUG("Scanning for temperature sensors");
 #endif
-            bus_.reset_search();
-            state_ = State::SCANNING;
+                bus_.reset_search();
+                state_     = State::SCANNING;
+                rescan_    = false;
+                last_scan_ = time_now;
+                sensorscans_++;
+            } else {
+                read_index_ = 0;
+                state_      = State::READING_ROM;
+            }
         } else if (time_now - last_activity_ > READ_TIMEOUT_MS) {
 #ifdef EMSESP_DEBUG_SENSOR
             LOG_WARNING("Sensor read timeout");
@@ -119,6 +133,24 @@ void TemperatureSensor::loop() {
             state_ = State::IDLE;
             sensorfails_++;
         }
+    } else if (state_ == State::READING_ROM) {
+        // skip sensors that went missing, they come back with the next bus search
+        while (read_index_ < sensors_.size() && sensors_[read_index_].temperature_c == EMS_VALUE_INT16_NOTSET) {
+            read_index_++;
+        }
+        if (read_index_ < sensors_.size()) {
+            auto &  sensor = sensors_[read_index_++];
+            int16_t t      = get_temperature_c(sensor.rom());
+            if ((t >= -550) && (t <= 1250)) {
+                sensorreads_++;
+                set_temperature(sensor, t);
+            } else {
+                sensorfails_++;
+                rescan_ = true;
+            }
+        } else {
+            end_cycle();
+        }
     } else if (state_ == State::SCANNING) {
         if (time_now - last_activity_ > SCAN_TIMEOUT_MS) {
 #ifdef EMSESP_DEBUG_SENSOR
@@ -147,14 +179,8 @@ void TemperatureSensor::loop() {
                             bool found = false;
                             for (auto & sensor : sensors_) {
                                 if (sensor.internal_id() == get_id(addr)) {
-                                    t += sensor.offset();
-                                    if (t != sensor.temperature_c) {
-                                        sensor.temperature_c = t;
-                                        publish_sensor(sensor);
-                                        changed_ |= true;
-                                    }
-                                    sensor.read = true;
-                                    found       = true;
+                                    set_temperature(sensor, t);
+                                    found = true;
                                     break;
                                 }
                             }
@@ -185,57 +211,84 @@ void TemperatureSensor::loop() {
                     LOG_ERROR("Invalid sensor %s", Sensor(addr).id().c_str());
                 }
             } else {
-                if (!parasite_) {
-                    bus_.depower();
-                }
-                // check for missing sensors after some samples
-                // but don't do this if running in test mode where we simulate sensors
-                if (++scancnt_ > SCAN_MAX) {
-                    for (auto & sensor : sensors_) {
-                        if (!sensor.read) {
-                            sensor.temperature_c = EMS_VALUE_INT16_NOTSET;
-                            changed_             = true;
-                        }
-                        sensor.read = false;
-                    }
-                    scancnt_ = 0;
-                } else if (scancnt_ == SCAN_START + 1) { // startup
-                    firstscan_ = sensors_.size();
-                    if (firstscan_ > 0 && set_internal_) {
-                        set_internal_ = false;
-                        Sensor * s    = &sensors_[0];
-                        if (firstscan_ > 1) {
-                            std::string s_nvs = EMSESP::nvs_.getString("intTemp").c_str();
-                            for (uint8_t i = 0; i < firstscan_; i++) {
-                                if (s_nvs == sensors_[i].id()) {
-                                    s = &sensors_[i];
-                                    break;
-                                }
-                            }
-                        }
-                        s->set_name("gateway_temperature");
-                        if (!EMSESP::nvs_.isKey("intTemp")) {
-                            EMSESP::nvs_.putString("intTemp", s->id().c_str());
-                        }
-                        EMSESP::webCustomizationService.update([&](WebCustomization & settings) {
-                            auto newSensor   = SensorCustomization();
-                            newSensor.id     = s->id();
-                            newSensor.name   = s->name();
-                            newSensor.offset = 0;
-                            settings.sensorCustomizations.push_back(newSensor);
-                            return StateUpdateResult::CHANGED;
-                        });
+                end_cycle();
+            }
+        }
+    }
+
+    bus_us_ += micros() - bus_start;
+    if (state_ == State::IDLE) {
+        bus_time_ = bus_us_;
+        if (bus_us_ > bus_time_max_) {
+            bus_time_max_ = bus_us_;
+        }
+        bus_us_ = 0;
+    }
+#endif
+}
+
+#ifndef EMSESP_STANDALONE
+// all sensors are read, check for missing ones and handle the startup scans
+void TemperatureSensor::end_cycle() {
+    if (!parasite_) {
+        bus_.depower();
+    }
+    // check for missing sensors after some samples
+    // but don't do this if running in test mode where we simulate sensors
+    if (++scancnt_ > SCAN_MAX) {
+        for (auto & sensor : sensors_) {
+            if (!sensor.read) {
+                sensor.temperature_c = EMS_VALUE_INT16_NOTSET;
+                changed_             = true;
+            }
+            sensor.read = false;
+        }
+        scancnt_ = 0;
+    } else if (scancnt_ == SCAN_START + 1) { // startup
+        firstscan_ = sensors_.size();
+        if (firstscan_ > 0 && set_internal_) {
+            set_internal_ = false;
+            Sensor * s    = &sensors_[0];
+            if (firstscan_ > 1) {
+                std::string s_nvs = EMSESP::nvs_.getString("intTemp").c_str();
+                for (uint8_t i = 0; i < firstscan_; i++) {
+                    if (s_nvs == sensors_[i].id()) {
+                        s = &sensors_[i];
+                        break;
                     }
-                    // LOG_DEBUG("Adding %d sensor(s) from first scan", firstscan_);
-                } else if ((scancnt_ <= 0) && (firstscan_ != sensors_.size())) { // check 2 times for no change of sensor #
-                    scancnt_ = SCAN_START;
-                    sensors_.clear(); // restart scanning and clear to get correct numbering
                 }
-                state_ = State::IDLE;
             }
+            s->set_name("gateway_temperature");
+            if (!EMSESP::nvs_.isKey("intTemp")) {
+                EMSESP::nvs_.putString("intTemp", s->id().c_str());
+            }
+            EMSESP::webCustomizationService.update([&](WebCustomization & settings) {
+                auto newSensor   = SensorCustomization();
+                newSensor.id     = s->id();
+                newSensor.name   = s->name();
+                newSensor.offset = 0;
+                settings.sensorCustomizations.push_back(newSensor);
+                return StateUpdateResult::CHANGED;
+            });
         }
+        // LOG_DEBUG("Adding %d sensor(s) from first scan", firstscan_);
+    } else if ((scancnt_ <= 0) && (firstscan_ != sensors_.size())) { // check 2 times for no change of sensor #
+        scancnt_ = SCAN_START;
+        sensors_.clear(); // restart scanning and clear to get correct numbering
     }
+    state_ = State::IDLE;
+}
 #endif
+
+// store a new reading of a known sensor, t is without the offset
+void TemperatureSensor::set_temperature(Sensor & sensor, int16_t t) {
+    t += sensor.offset();
+    if (t != sensor.temperature_c) {
+        sensor.temperature_c = t;
+        publish_sensor(sensor);
+        changed_ |= true;
+    }
+    sensor.read = true;
 }
 
 bool TemperatureSensor::temperature_convert_complete() {
@@ -435,9 +488,11 @@ void TemperatureSensor::publish_sensor(const Sensor & sensor) {
         char payload[10];
         Mqtt::queue_publish(topic, Helpers::render_value(payload, sensor.temperature_c, 10, EMSESP::system_.fahrenheit() ? 2 : 0));
     }
-    char cmd[COMMAND_MAX_LENGTH];
-    snprintf(cmd, sizeof(cmd), "%s/%s", F_(temperaturesensor), sensor.name().c_str());
-    EMSESP::webSchedulerService.onChange(cmd);
+    if (EMSESP::webSchedulerService.has_subscriptions()) {
+        char cmd[COMMAND_MAX_LENGTH];
+        snprintf(cmd, sizeof(cmd), "%s/%s", F_(temperaturesensor), sensor.name().c_str());
+        EMSESP::webSchedulerService.onChange(cmd);
+    }
 }
 
 // send empty config topic to remove the entry from HA
@@ -567,6 +622,8 @@ void TemperatureSensor::publish_values(const bool force) {
 TemperatureSensor::Sensor::Sensor(const uint8_t addr[])
     : internal_id_(((uint64_t)addr[0] << 48) | ((uint64_t)addr[1] << 40) | ((uint64_t)addr[2] << 32) | ((uint64_t)addr[3] << 24) | ((uint64_t)addr[4] << 16)
                    | ((uint64_t)addr[5] << 8) | ((uint64_t)addr[6])) {
+    memcpy(rom_, addr, sizeof(rom_));
+
     // create ID string
     char id_s[20];
     snprintf(id_s,
@@ -44,6 +44,10 @@ class TemperatureSensor {
             return internal_id_;
         }
 
+        const uint8_t * rom() const {
+            return rom_;
+        }
+
         std::string id() const {
             return id_;
         }
@@ -69,6 +73,7 @@ class TemperatureSensor {
 
       private:
         uint64_t    internal_id_;
+        uint8_t     rom_[8]; // 1-Wire ROM code for addressed reads
         std::string id_;
         std::string name_;
         int16_t     offset_;
@@ -98,6 +103,19 @@ class TemperatureSensor {
         return sensorfails_;
     }
 
+    uint32_t scans() const {
+        return sensorscans_;
+    }
+
+    // bus time in us of the last and the longest read cycle
+    uint32_t bus_time() const {
+        return bus_time_;
+    }
+
+    uint32_t bus_time_max() const {
+        return bus_time_max_;
+    }
+
     bool sensor_enabled() const {
         return (dallas_gpio_ != 0);
     }
@@ -119,7 +137,7 @@ class TemperatureSensor {
   private:
     static constexpr uint8_t MAX_SENSORS = 20;
 
-    enum class State { IDLE, READING, SCANNING };
+    enum class State { IDLE, READING, SCANNING, READING_ROM };
 
     static constexpr size_t ADDR_LEN = 8;
 
@@ -135,10 +153,11 @@ class TemperatureSensor {
     static constexpr uint8_t TYPE_DS1822  = 0x22;
     static constexpr uint8_t TYPE_DS1825  = 0x3B; // also DS1826
 
-    static constexpr uint32_t READ_INTERVAL_MS = 5000; // 5 seconds
-    static constexpr uint32_t CONVERSION_MS    = 1000; // 1 seconds
-    static constexpr uint32_t READ_TIMEOUT_MS  = 2000; // 2 seconds
-    static constexpr uint32_t SCAN_TIMEOUT_MS  = 3000; // 3 seconds
+    static constexpr uint32_t READ_INTERVAL_MS = 5000;  // 5 seconds
+    static constexpr uint32_t CONVERSION_MS    = 1000;  // 1 seconds
+    static constexpr uint32_t READ_TIMEOUT_MS  = 2000;  // 2 seconds
+    static constexpr uint32_t SCAN_TIMEOUT_MS  = 3000;  // 3 seconds
+    static constexpr uint32_t RESCAN_MS        = 60000; // 1 minute, full bus search for new sensors
 
     static constexpr uint8_t CMD_CONVERT_TEMP    = 0x44;
     static constexpr uint8_t CMD_READ_SCRATCHPAD = 0xBE;
@@ -151,6 +170,8 @@ class TemperatureSensor {
     bool     temperature_convert_complete();
     int16_t  get_temperature_c(const uint8_t addr[]);
     uint64_t get_id(const uint8_t addr[]);
+    void     set_temperature(Sensor & sensor, int16_t t);
+    void     end_cycle();
     void     get_value_json(JsonObject output, const Sensor & sensor);
     void     remove_ha_topic(const std::string & id);
 
@@ -163,6 +184,10 @@ class TemperatureSensor {
     int8_t   scancnt_       = SCAN_START;
     uint8_t  firstscan_     = 0;
     int8_t   scanretry_     = 0;
+    uint32_t last_scan_     = 0;
+    bool     rescan_        = false; // a known sensor failed, search the bus in the next cycle
+    uint8_t  read_index_    = 0;     // next sensor of the ROM table to read
+    uint32_t bus_us_        = 0;     // bus time of the current cycle
 #endif
 
     uint8_t  dallas_gpio_  = 0;
@@ -170,6 +195,9 @@ class TemperatureSensor {
     bool     changed_      = false;
     uint32_t sensorfails_  = 0;
     uint32_t sensorreads_  = 0;
+    uint32_t sensorscans_  = 0;
+    uint32_t bus_time_     = 0;
+    uint32_t bus_time_max_ = 0;
     bool     set_internal_ = false;
 };
 
@@ -0,0 +1,463 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020-2024  emsesp.org - proddy, MichaelDvP
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if defined(EMSESP_STANDALONE)
+
+#include "simulator.h"
+
+#include <ctime>
+#include <fstream>
+#include <thread>
+
+namespace emsesp {
+
+std::deque<Simulator::TxFrame> Simulator::tx_frames_;
+
+static constexpr uint32_t WRITE_INTERVAL_MS = 60000; // scripted thermostat setpoint changes
+
+Simulator::Simulator() {
+    tx_frames_.clear();
+    EMSuart::tx_handler(on_transmit);
+}
+
+Simulator::~Simulator() {
+    EMSuart::tx_handler(nullptr);
+    tx_frames_.clear();
+}
+
+// called from the UART when EMS-ESP sends a poll ack or a telegram
+// this is still within TxService::send(), so the telegram is at the front of the Tx queue
+void Simulator::on_transmit(const uint8_t * data, const uint8_t length) {
+    TxFrame frame;
+    frame.queued = (length > 1) && !EMSESP::txservice_.tx_queue_empty();
+    frame.id     = frame.queued ? EMSESP::txservice_.queue().front().id_ : 0;
+    frame.data.assign(data, data + length);
+    tx_frames_.push_back(std::move(frame));
+}
+
+void Simulator::add_device(const uint8_t device_id, const uint8_t product_id, const uint8_t version_major, const uint8_t version_minor) {
+    devices_.push_back({device_id, product_id, {version_major, version_minor}, {}});
+}
+
+// adds a block of device memory, which is broadcasted every broadcast_ms when the device is polled
+void Simulator::add_register(const uint8_t device_id, const uint16_t type_id, const std::vector<uint8_t> & data, const uint32_t broadcast_ms) {
+    Device * device = find_device(device_id);
+    if (device) {
+        device->registers.push_back({type_id, data, broadcast_ms, 0});
+    }
+}
+
+// GB072 boiler as bus master, RC310 thermostat and two MM100 mixers, with data from real systems
+void Simulator::load_models() {
+    add_device(0x08, 123, 3, 3); // GB072
+    add_device(0x10, 158, 3, 3); // RC310
+    add_device(0x20, 160, 2, 2); // MM100 on HC1
+    add_device(0x21, 160, 2, 2); // MM100 on HC2
+
+    // UBADevices(0x07), a bit for every device on the bus including us
+    std::vector<uint8_t> devices(13, 0);
+    for (const auto & device : devices_) {
+        devices[(device.device_id / 8) - 1] |= 1 << (device.device_id % 8);
+    }
+    devices[(EMSbus::ems_bus_id() / 8) - 1] |= 1 << (EMSbus::ems_bus_id() % 8);
+    add_register(0x08, 0x07, devices, 30000);
+
+    // UBAMonitorFast(0x18)
+    add_register(0x08,
+                 0x18,
+                 {0x00, 0x02, 0x5A, 0x73, 0x3D, 0x0A, 0x10, 0x65, 0x40, 0x02, 0x1A, 0x80, 0x00,
+                  0x01, 0xE1, 0x01, 0x76, 0x0E, 0x3D, 0x48, 0x00, 0xC9, 0x44, 0x02, 0x00},
+                 10000);
+    // UBAMonitorWW(0x34)
+    add_register(0x08, 0x34, {0x36, 0x01, 0xA5, 0x80, 0x00, 0x21, 0x00, 0x00, 0x01, 0x00, 0x01, 0x3E, 0x8D, 0x03, 0x77, 0x91, 0x00, 0x80, 0x00}, 10000);
+    // UBATotalUptime(0x14)
+    add_register(0x08, 0x14, {0x3C, 0x1F, 0xAC, 0x70});
+    // UBAParameterWW(0x33)
+    add_register(0x08, 0x33, {0x08, 0xFF, 0x34, 0xFB, 0x00, 0x28, 0x00, 0x00, 0x46, 0x00, 0xFF, 0xFF, 0x00});
+
+    // RC300Monitor(0x02A5) for HC1
+    add_register(0x10,
+                 0x02A5,
+                 {0x80, 0x00, 0x01, 0x30, 0x28, 0x00, 0x30, 0x28, 0x01, 0x54, 0x03, 0x03, 0x01,
+                  0x01, 0x54, 0x02, 0xA8, 0x00, 0x00, 0x11, 0x01, 0x03, 0xFF, 0xFF, 0x00},
+                 15000);
+    // RC300WWmode(0x02F5), which the RC310 repeats to the boiler on its own
+    add_register(0x10, 0x02F5, {0x01, 0xFF, 0x04, 0x00, 0x00, 0x00, 0x08, 0x05, 0x00, 0x08, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01}, 30000);
+    // RC300WWmode2(0x031D)
+    add_register(0x10, 0x031D, {0x00, 0x00, 0x09, 0x07});
+
+    // MMPLUSStatusMessage_HC1(0x02D7) and HC2(0x02D8)
+    add_register(0x20, 0x02D7, {0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x03, 0xC5}, 10000);
+    add_register(0x21, 0x02D8, {0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x03, 0xC5}, 10000);
+}
+
+Simulator::Device * Simulator::find_device(const uint8_t device_id) {
+    for (auto & device : devices_) {
+        if (device.device_id == device_id) {
+            return &device;
+        }
+    }
+    return nullptr;
+}
+
+Simulator::Register * Simulator::find_register(Device & device, const uint16_t type_id) {
+    for (auto & reg : device.registers) {
+        if (reg.type_id == type_id) {
+            return &reg;
+        }
+    }
+    return nullptr;
+}
+
+// hands a frame to EMS-ESP as the UART would, after it has been on the bus
+void Simulator::bus_write(const uint8_t * data, const uint8_t length) {
+    static uint8_t frame[EMS_MAX_TELEGRAM_LENGTH];
+    memcpy(frame, data, length);
+
+    now_us_ += (uint64_t)length * BYTE_TIME_US + SLOT_GAP_US;
+    if (length == 1) {
+        stats_.polls++;
+    } else {
+        stats_.telegrams++;
+    }
+
+    EMSESP::incoming_telegram(frame, length);
+}
+
+// builds a telegram from a device, EMS 1.0 or EMS+ depending on the type_id, and puts it on the bus
+void Simulator::send_frame(const uint8_t device_id, const uint8_t dest, const uint16_t type_id, const uint8_t offset, const uint8_t * data, const uint8_t length) {
+    uint8_t frame[EMS_MAX_TELEGRAM_LENGTH];
+    uint8_t n  = 0;
+    frame[n++] = device_id;
+    frame[n++] = dest;
+    if (type_id > 0xFF) {
+        frame[n++] = 0xFF;
+        frame[n++] = offset;
+        frame[n++] = (type_id >> 8) - 1;
+        frame[n++] = type_id & 0xFF;
+    } else {
+        frame[n++] = type_id;
+        frame[n++] = offset;
+    }
+
+    uint8_t size = std::min<uint8_t>(length, EMS_MAX_TELEGRAM_LENGTH - n - 1); // leave room for the CRC
+    if (size) {
+        memcpy(&frame[n], data, size);
+        n += size;
+    }
+    frame[n] = EMSbus::calculate_crc(frame, n);
+
+    bus_write(frame, n + 1);
+}
+
+// sends the next broadcast that is due, returns false if there is none
+bool Simulator::send_broadcast(Device & device) {
+    for (auto & reg : device.registers) {
+        if (reg.broadcast_ms && now_us_ >= reg.next_us) {
+            reg.next_us = now_us_ + (uint64_t)reg.broadcast_ms * 1000;
+            send_frame(device.device_id, 0x00, reg.type_id, 0, reg.data.data(), reg.data.size());
+            return true;
+        }
+    }
+    return false;
+}
+
+// one round of the master: its own broadcasts, then a poll for every device and us
+void Simulator::poll_cycle() {
+    uint8_t mask = (EMSbus::ems_mask() == EMSbus::EMS_MASK_UNSET) ? 0 : EMSbus::ems_mask();
+
+    for (auto & device : devices_) {
+        if (&device == &devices_.front()) {
+            while (send_broadcast(device)) {
+            }
+            continue;
+        }
+
+        uint8_t poll = device.device_id ^ 0x80 ^ mask;
+        bus_write(&poll, 1);
+        if (!send_broadcast(device)) {
+            now_us_ += BYTE_TIME_US + SLOT_GAP_US; // poll ack
+        }
+    }
+
+    uint8_t poll = EMSbus::ems_bus_id() ^ 0x80 ^ mask;
+    bus_write(&poll, 1);
+    process_tx();
+}
+
+// puts whatever EMS-ESP sent on the bus and lets the addressed device answer
+// answering can make EMS-ESP send again (poll ack, next part of a read), so loop until it is quiet
+void Simulator::process_tx() {
+    while (!tx_frames_.empty()) {
+        TxFrame frame = std::move(tx_frames_.front());
+        tx_frames_.pop_front();
+
+        if (frame.data.size() == 1) {
+            now_us_ += BYTE_TIME_US + SLOT_GAP_US; // poll ack, releases the bus
+            continue;
+        }
+
+        if (frame.queued) {
+            auto     it   = tx_queued_.find(frame.id);
+            uint64_t wait = (it == tx_queued_.end()) ? 0 : now_us_ - it->second;
+            if (it != tx_queued_.end()) {
+                tx_queued_.erase(it);
+            }
+            stats_.tx_waits++;
+            stats_.tx_wait_total_us += wait;
+            stats_.tx_wait_max_us = std::max<uint32_t>(stats_.tx_wait_max_us, wait);
+        }
+
+        bus_write(frame.data.data(), frame.data.size()); // the echo
+
+        if (!reply(frame)) {
+            stats_.tx_no_reply++;
+            now_us_ += TX_TIMEOUT_US;
+        }
+    }
+}
+
+// the addressed device answers a read with its register memory and acknowledges a write
+// unknown types are answered with an empty telegram, like the real devices do
+bool Simulator::reply(const TxFrame & frame) {
+    const uint8_t * data = frame.data.data();
+    uint8_t         len  = frame.data.size() - 1; // without CRC
+    if (len < 5) {
+        return false;
+    }
+
+    bool     read   = data[1] & 0x80;
+    Device * device = find_device(data[1] & 0x7F);
+    if (!device) {
+        return false;
+    }
+
+    uint16_t        type_id;
+    uint8_t         offset = data[3];
+    uint8_t         length;
+    const uint8_t * message = nullptr;
+    if (data[2] == 0xFF) {
+        if (read) {
+            if (len < 7) {
+                return false;
+            }
+            length  = data[4];
+            type_id = (data[5] << 8) + data[6] + 256;
+        } else {
+            type_id = (data[4] << 8) + data[5] + 256;
+            message = &data[6];
+            length  = len - 6;
+        }
+    } else {
+        type_id = data[2];
+        if (read) {
+            length = data[4];
+        } else {
+            message = &data[4];
+            length  = len - 4;
+        }
+    }
+
+    if (read) {
+        stats_.tx_reads++;
+        if (type_id == EMSdevice::EMS_TYPE_VERSION) {
+            uint8_t version[] = {device->product_id, device->version[0], device->version[1]};
+            send_frame(device->device_id, EMSbus::ems_bus_id(), type_id, 0, version, sizeof(version));
+            return true;
+        }
+        Register * reg  = find_register(*device, type_id);
+        uint8_t    size = 0;
+        if (reg && offset < reg->data.size()) {
+            size = std::min<size_t>(length, reg->data.size() - offset);
+        }
+        send_frame(device->device_id, EMSbus::ems_bus_id(), type_id, offset, size ? &reg->data[offset] : nullptr, size);
+        return true;
+    }
+
+    stats_.tx_writes++;
+    Register * reg = find_register(*device, type_id);
+    if (!reg) {
+        device->registers.push_back({type_id, {}, 0, 0});
+        reg = &device->registers.back();
+    }
+    if (reg->data.size() < (size_t)offset + length) {
+        reg->data.resize(offset + length);
+    }
+    memcpy(&reg->data[offset], message, length);
+
+    uint8_t ack = TxService::TX_WRITE_SUCCESS;
+    bus_write(&ack, 1);
+    return true;
+}
+
+// the parts of EMSESP::loop() that deal with the bus
+// the standalone clock behind uuid::get_uptime() counts in microseconds and only moves with delay(),
+// so it follows the bus time and all timeouts and intervals in EMS-ESP work as on a real bus
+void Simulator::main_loop() {
+    delay(now_us_ - clock_us_);
+    clock_us_ = now_us_;
+    uuid::loop();
+
+    EMSESP::rxservice_.loop();
+
+    // note when telegrams enter the Tx queue, to measure how long they wait for their turn on the bus
+    for (const auto & tx_telegram : EMSESP::txservice_.queue()) {
+        tx_queued_.emplace(tx_telegram.id_, now_us_);
+    }
+}
+
+// sleeps to keep the bus at speed x real time, or runs flat out for speed 0
+void Simulator::pace(const uint16_t speed) {
+    if (speed) {
+        std::this_thread::sleep_until(start_wall_ + std::chrono::microseconds((now_us_ - start_us_) / speed));
+    }
+}
+
+// runs the bus for duration_ms of bus time, changing the thermostat setpoint every minute
+void Simulator::run(const uint32_t duration_ms, const uint16_t speed) {
+    start_us_         = now_us_;
+    start_wall_       = std::chrono::steady_clock::now();
+    std::clock_t cpu  = std::clock();
+    uint64_t     end  = now_us_ + (uint64_t)duration_ms * 1000;
+    bool         high = false;
+
+    while (now_us_ < end) {
+        poll_cycle();
+        main_loop();
+        EMSESP::scheduled_fetch_values();
+
+        if (now_us_ >= write_us_) {
+            write_us_ = now_us_ + (uint64_t)WRITE_INTERVAL_MS * 1000;
+            if (EMSESP::device_exists(0x10)) {
+                Command::call(EMSdevice::DeviceType::THERMOSTAT, "seltemp", high ? "21.5" : "20.5");
+                high = !high;
+            }
+        }
+
+        pace(speed);
+    }
+
+    stats_.bus_time_us += now_us_ - start_us_;
+    stats_.wall_time_us += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_wall_).count();
+    stats_.cpu_time_us += (uint64_t)(std::clock() - cpu) * 1000000 / CLOCKS_PER_SEC;
+}
+
+// replays a raw log as captured with 'watch raw', either the console/syslog lines with "Rx: " or plain hex bytes
+// lines with a timestamp are replayed at their time, others back to back at bus speed
+// we only listen, so nothing is sent while replaying
+bool Simulator::replay(const char * filename, const uint16_t speed) {
+    std::ifstream file(filename);
+    if (!file) {
+        return false;
+    }
+
+    uint8_t tx_mode = EMSbus::tx_mode();
+    EMSbus::tx_mode(0);
+
+    start_us_              = now_us_;
+    start_wall_            = std::chrono::steady_clock::now();
+    std::clock_t cpu       = std::clock();
+    bool         have_base = false;
+    uint64_t     base_us   = 0;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        // timestamp as 000+00:00:00.000 (uptime) or 2024-01-01T00:00:00.000 (with NTP)
+        unsigned long days = 0;
+        unsigned int  hours, minutes, seconds, ms;
+        bool          timed = (sscanf(line.c_str(), "%lu+%u:%u:%u.%u", &days, &hours, &minutes, &seconds, &ms) == 5)
+                     || (sscanf(line.c_str(), "%*4d-%*2d-%*2dT%u:%u:%u.%u", &hours, &minutes, &seconds, &ms) == 4);
+
+        const char * p   = line.c_str();
+        size_t       pos = line.find("Rx: ");
+        if (pos != std::string::npos) {
+            p += pos + 4;
+        } else if (timed) {
+            continue; // some other log line
+        }
+
+        uint8_t data[EMS_MAX_TELEGRAM_LENGTH];
+        uint8_t length = 0;
+        while (length < EMS_MAX_TELEGRAM_LENGTH) {
+            char * end;
+            long   value = strtol(p, &end, 16);
+            if (end == p || value < 0 || value > 0xFF) {
+                break;
+            }
+            data[length++] = value;
+            p              = end;
+        }
+        if (!length) {
+            continue;
+        }
+
+        if (timed) {
+            uint64_t at = ((((uint64_t)days * 24 + hours) * 60 + minutes) * 60 + seconds) * 1000000 + (uint64_t)ms * 1000;
+            if (!have_base) {
+                base_us   = now_us_ - at;
+                have_base = true;
+            }
+            now_us_ = std::max(now_us_, base_us + at);
+        }
+
+        bus_write(data, length);
+        main_loop();
+        pace(speed);
+    }
+
+    EMSbus::tx_mode(tx_mode);
+    tx_frames_.clear();
+
+    stats_.bus_time_us += now_us_ - start_us_;
+    stats_.wall_time_us += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_wall_).count();
+    stats_.cpu_time_us += (uint64_t)(std::clock() - cpu) * 1000000 / CLOCKS_PER_SEC;
+    return true;
+}
+
+void Simulator::report(uuid::console::Shell & shell) const {
+    uint32_t bus_ms  = stats_.bus_time_us / 1000;
+    uint32_t wall_ms = stats_.wall_time_us / 1000;
+    shell.printfln("Bus time %d s in %d ms (%dx real time)", bus_ms / 1000, wall_ms, wall_ms ? bus_ms / wall_ms : 0);
+    shell.printfln("Processed %d telegrams and %d polls, %d telegrams/s, CPU %d us per telegram",
+                   stats_.telegrams,
+                   stats_.polls,
+                   stats_.wall_time_us ? (uint32_t)((uint64_t)stats_.telegrams * 1000000 / stats_.wall_time_us) : 0,
+                   stats_.telegrams ? (uint32_t)(stats_.cpu_time_us / stats_.telegrams) : 0);
+    shell.printfln("Tx %d reads, %d writes, %d without reply, queue wait avg %d ms, max %d ms",
+                   stats_.tx_reads,
+                   stats_.tx_writes,
+                   stats_.tx_no_reply,
+                   stats_.tx_waits ? (uint32_t)(stats_.tx_wait_total_us / stats_.tx_waits / 1000) : 0,
+                   stats_.tx_wait_max_us / 1000);
+    static const char * const lanes[] = {"writes", "validation reads", "fetches"};
+    for (uint8_t lane = 0; lane < TxService::TX_LANES; lane++) {
+        const auto & lane_stats = EMSESP::txservice_.lane_stats(lane);
+        shell.printfln("Tx %s: %d sent, wait avg %d ms, max %d ms",
+                       lanes[lane],
+                       lane_stats.sent,
+                       lane_stats.sent ? (uint32_t)(lane_stats.wait_total / lane_stats.sent) : 0,
+                       lane_stats.wait_max);
+    }
+    shell.printfln("Tx merged into pending telegrams: %d", EMSESP::txservice_.merged_count());
+    shell.printfln("Fetch read requests: %d sent, %d saved", EMSdevice::fetch_requests(), EMSdevice::fetch_skipped());
+    shell.printfln("Devices: %d, Rx errors: %d", EMSESP::count_devices(), EMSESP::rxservice_.telegram_error_count());
+}
+
+} // namespace emsesp
+
+#endif
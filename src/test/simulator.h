@@ -0,0 +1,123 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020-2024  emsesp.org - proddy, MichaelDvP
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if defined(EMSESP_STANDALONE)
+
+#ifndef EMSESP_SIMULATOR_H
+#define EMSESP_SIMULATOR_H
+
+#include "emsesp.h"
+
+#include <chrono>
+#include <deque>
+#include <unordered_map>
+
+namespace emsesp {
+
+// Virtual EMS bus for the standalone build
+// A master polls the modelled devices and us in turn, the devices answer our read and write requests
+// from their register memory and send their broadcasts when polled. Runs on a virtual bus clock at
+// 9600 baud, either as fast as possible or paced to N x real time.
+class Simulator {
+  public:
+    static constexpr uint32_t BYTE_TIME_US  = 1042;              // 9600 baud, 8N1 is 10 bits per byte
+    static constexpr uint32_t SLOT_GAP_US   = 2 * BYTE_TIME_US;  // bus idle between two frames
+    static constexpr uint32_t TX_TIMEOUT_US = 20 * BYTE_TIME_US; // how long the master waits for a missing reply
+
+    struct Stats {
+        uint64_t bus_time_us      = 0; // virtual bus time
+        uint64_t wall_time_us     = 0;
+        uint64_t cpu_time_us      = 0;
+        uint32_t telegrams        = 0; // frames with data handed to EMS-ESP, including echos and replies
+        uint32_t polls            = 0;
+        uint32_t tx_reads         = 0;
+        uint32_t tx_writes        = 0;
+        uint32_t tx_no_reply      = 0;
+        uint32_t tx_waits         = 0; // Tx telegrams with a measured queue wait
+        uint64_t tx_wait_total_us = 0; // time spent in the Tx queue, in bus time
+        uint32_t tx_wait_max_us   = 0;
+    };
+
+    Simulator();
+    ~Simulator();
+
+    void add_device(const uint8_t device_id, const uint8_t product_id, const uint8_t version_major, const uint8_t version_minor);
+    void add_register(const uint8_t device_id, const uint16_t type_id, const std::vector<uint8_t> & data, const uint32_t broadcast_ms = 0);
+    void load_models();
+
+    void run(const uint32_t duration_ms, const uint16_t speed = 0);
+    bool replay(const char * filename, const uint16_t speed = 0);
+
+    void report(uuid::console::Shell & shell) const;
+
+    const Stats & stats() const {
+        return stats_;
+    }
+
+  private:
+    struct Register {
+        uint16_t             type_id;
+        std::vector<uint8_t> data;
+        uint32_t             broadcast_ms; // 0 for registers that are only read on request
+        uint64_t             next_us;
+    };
+
+    struct TxFrame {
+        bool                 queued; // false for polls and acks
+        uint16_t             id;     // Tx queue id
+        std::vector<uint8_t> data;
+    };
+
+    struct Device {
+        uint8_t               device_id;
+        uint8_t               product_id;
+        uint8_t               version[2];
+        std::vector<Register> registers;
+    };
+
+    Device *   find_device(const uint8_t device_id);
+    Register * find_register(Device & device, const uint16_t type_id);
+
+    void poll_cycle();
+    bool send_broadcast(Device & device);
+    void send_frame(const uint8_t device_id, const uint8_t dest, const uint16_t type_id, const uint8_t offset, const uint8_t * data, const uint8_t length);
+    void bus_write(const uint8_t * data, const uint8_t length);
+    void process_tx();
+    bool reply(const TxFrame & frame);
+    void main_loop();
+    void pace(const uint16_t speed);
+
+    static void on_transmit(const uint8_t * data, const uint8_t length);
+
+    std::vector<Device>                    devices_;
+    std::unordered_map<uint16_t, uint64_t> tx_queued_;    // Tx queue id -> bus time when first seen
+    uint64_t                               now_us_   = 0; // virtual bus clock
+    uint64_t                               clock_us_ = 0; // bus time already added to the standalone clock
+    uint64_t                               write_us_ = 0; // next scripted write, in bus time
+    uint64_t                               start_us_ = 0;
+    std::chrono::steady_clock::time_point  start_wall_;
+    Stats                                  stats_;
+
+    static std::deque<TxFrame> tx_frames_; // what EMS-ESP put on the bus
+};
+
+} // namespace emsesp
+
+#endif
+
+#endif
@@ -20,6 +20,16 @@
 
 #include "test.h"
 
+#if defined(EMSESP_STANDALONE) && defined(__GLIBC__)
+#include <malloc.h>
+#include <Packets/Packet.h>
+#endif
+
+#if defined(EMSESP_STANDALONE)
+#include <thread>
+#include "simulator.h"
+#endif
+
 namespace emsesp {
 
 // no shell, called via the API or 'call system test' command
@@ -657,6 +667,529 @@ void Test::run_test(uuid::console::Shell & shell, const std::string & cmd, const
         ok = true;
     }
 
+#if defined(EMSESP_STANDALONE)
+    // stress test of the Rx ring with the producer (UART task) and consumer (main loop) on separate threads
+    // every frame carries a sequence number and a pattern, checked by the consumer
+    // e.g. "test rxring 100" for 100.000 frames
+    if (command == "rxring") {
+        shell.printfln("Stress testing Rx ring...");
+        static RxFrameRing ring;
+        uint32_t           frames = (id1 > 0 ? id1 : 100) * 1000;
+
+        std::atomic<bool> done{false};
+        std::thread       producer([&]() {
+            uint8_t data[EMS_MAX_TELEGRAM_LENGTH];
+            for (uint32_t seq = 0; seq < frames; seq++) {
+                uint8_t length = 6 + seq % (EMS_MAX_TELEGRAM_LENGTH - 5);
+                memcpy(data, &seq, sizeof(seq));
+                for (uint8_t i = sizeof(seq); i < length; i++) {
+                    data[i] = (uint8_t)(seq + i);
+                }
+                while (!ring.push(data, length, seq)) {
+                    std::this_thread::yield(); // full, the real UART task drops the frame
+                }
+            }
+            done = true;
+        });
+
+        uint32_t received = 0;
+        uint32_t errors   = 0;
+        auto     start    = std::chrono::steady_clock::now();
+        while (!done || ring.front()) {
+            auto frame = ring.front();
+            if (!frame) {
+                std::this_thread::yield();
+                continue;
+            }
+            uint32_t seq;
+            memcpy(&seq, frame->data, sizeof(seq));
+            bool ok_frame = (seq == received) && (frame->timestamp == seq) && (frame->length == 6 + seq % (EMS_MAX_TELEGRAM_LENGTH - 5));
+            for (uint8_t i = sizeof(seq); ok_frame && i < frame->length; i++) {
+                ok_frame = (frame->data[i] == (uint8_t)(seq + i));
+            }
+            if (!ok_frame) {
+                errors++;
+            }
+            received++;
+            ring.pop();
+        }
+        producer.join();
+        uint64_t elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+        shell.printfln("Sent %d frames, received %d, %d errors, %d full (retried), max %d of %d in ring, %d ms",
+                       frames,
+                       received,
+                       errors,
+                       ring.overflow_count(),
+                       ring.high_water(),
+                       RxFrameRing::SIZE,
+                       (uint32_t)(elapsed / 1000));
+        ok = true;
+    }
+
+    // runs the virtual EMS bus with a GB072, RC310 and two MM100 and reports throughput and Tx latency
+    // e.g. "test simulate 600" for 10 minutes of bus time as fast as possible, "test simulate 60 1" in real time
+    if (command == "simulate") {
+        shell.printfln("Simulating EMS bus...");
+        EMSESP::watch(EMSESP::Watch::WATCH_OFF);
+        auto log_level = shell.log_level();
+        shell.log_level(uuid::log::Level::NOTICE);
+
+        Simulator simulator;
+        simulator.load_models();
+        simulator.run((id1 > 0 ? id1 : 300) * 1000, id2 > 0 ? id2 : 0);
+
+        shell.log_level(log_level);
+        simulator.report(shell);
+        ok = true;
+    }
+
+    // replays a raw log captured with 'watch raw' at N x speed, or as fast as possible
+    // e.g. "test replay /tmp/ems.log 10"
+    if (command == "replay") {
+        if (id1_s.empty()) {
+            shell.printfln("Usage: test replay <file> [speed]");
+            return;
+        }
+        shell.printfln("Replaying %s...", id1_s.c_str());
+        EMSESP::watch(EMSESP::Watch::WATCH_OFF);
+        auto log_level = shell.log_level();
+        shell.log_level(uuid::log::Level::NOTICE);
+
+        Simulator simulator;
+        bool      replayed = simulator.replay(id1_s.c_str(), id2 > 0 ? id2 : 0);
+
+        shell.log_level(log_level);
+        if (replayed) {
+            simulator.report(shell);
+        } else {
+            shell.printfln("Cannot open %s", id1_s.c_str());
+        }
+        ok = true;
+    }
+
+    // logs a burst of messages like 'watch on' does and measures what a web log client receives
+    // e.g. "test weblog 20 10" for 20000 messages, 10 per main loop
+    if (command == "weblog") {
+        shell.printfln("Benchmarking web log...");
+        uint32_t messages = (id1 > 0 ? id1 : 10) * 1000;
+        uint32_t per_loop = id2 > 0 ? id2 : 10;
+        auto     log_level = shell.log_level();
+        shell.log_level(uuid::log::Level::WARNING);
+
+        uint32_t delivered = 0;
+        uint32_t events    = 0;
+        uint32_t lost      = 0;
+        uint32_t errors    = 0;
+        uint32_t last_id   = 0;
+        size_t   bytes     = 0;
+        uint64_t client_us = 0; // time spent parsing in the client, not counted
+        EMSESP::webLogService.loop(); // flush what is there
+        EMSESP::webLogService.events().onSend([&](const char * message, const char * event, uint32_t id) {
+            auto         start = std::chrono::steady_clock::now();
+            JsonDocument doc;
+            if (deserializeJson(doc, message) || !doc.is<JsonArray>()) {
+                errors++;
+                return;
+            }
+            for (JsonObject entry : doc.as<JsonArray>()) {
+                uint32_t i = entry["i"];
+                if (last_id && i > last_id + 1) {
+                    lost += i - last_id - 1;
+                }
+                last_id = i;
+                delivered++;
+            }
+            events++;
+            bytes += strlen(message);
+            client_us += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        });
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < messages; i++) {
+            EMSESP::logger().notice("boiler(0x08) -> all(0x00), UBAMonitorFast(0x18), data: 00 02 5A 73 3D 0A 10 65 40 02 1A 80 00 01 E1 01 76 0E 3D 48 00 #%d",
+                                    i);
+            if ((i + 1) % per_loop == 0) {
+                EMSESP::webLogService.loop();
+            }
+        }
+        for (uint32_t i = 0; i < messages; i++) {
+            EMSESP::webLogService.loop(); // drain
+        }
+        uint64_t elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count() - client_us;
+        EMSESP::webLogService.events().onSend(nullptr);
+        shell.log_level(log_level);
+
+        shell.printfln("Logged %d messages, %d per loop: %d delivered in %d events, %d lost, %d errors",
+                       messages,
+                       per_loop,
+                       delivered,
+                       events,
+                       lost,
+                       errors);
+        if (events) {
+            shell.printfln("Average %d messages and %d bytes per event, %d messages/s", delivered / events, bytes / events, (uint32_t)(delivered * 1000000ULL / (elapsed ? elapsed : 1)));
+        }
+        ok = true;
+    }
+
+    // benchmarks Mqtt::incoming() with command topics, which repeat and are routed from the cache
+    // e.g. "test mqttbench 20" for 20k messages
+    if (command == "mqttbench") {
+        shell.printfln("Benchmarking MQTT incoming...");
+        uint32_t messages  = (id1 > 0 ? id1 : 10) * 1000;
+        auto     log_level = shell.log_level();
+        shell.log_level(uuid::log::Level::WARNING);
+
+        Mqtt::entity_format(Mqtt::entityFormat::SINGLE_LONG);
+        System::test_set_all_active(true);
+        add_device(0x08, 123); // Nefit Trendline
+        add_device(0x10, 158); // RC300
+
+        const char * topics[][2] = {
+            {"ems-esp/boiler/selflowtemp", ""},
+            {"ems-esp/boiler/curflowtemp", ""},
+            {"ems-esp/thermostat/hc1/seltemp", ""},
+            {"ems-esp/thermostat/hc1/mode", ""},
+            {"ems-esp/boiler", "{\"cmd\":\"selflowtemp\",\"data\":\"\"}"},
+            {"ems-esp/system/response", ""},
+        };
+        constexpr uint8_t num_topics = sizeof(topics) / sizeof(topics[0]);
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < messages; i++) {
+            EMSESP::mqtt_.incoming(topics[i % num_topics][0], topics[i % num_topics][1]);
+        }
+        uint64_t elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        shell.log_level(log_level);
+
+        shell.printfln("Routed %d messages over %d topics, %d messages/s", messages, num_topics, (uint32_t)(messages * 1000000ULL / (elapsed ? elapsed : 1)));
+        ok = true;
+    }
+
+    // pulse trains with contact bounce on a COUNTER and a RATE input while the loop is stalled
+    // all edges are captured and handed over in the next loop, e.g. "test pulses 500" for 500 pulses
+    if (command == "pulses") {
+        shell.printfln("Testing pulse counting with a stalled loop...");
+        EMSESP::webCustomizationService.test(); // load the analog sensors, test_analogsensor4 is a COUNTER on GPIO 33
+        std::string name = "test_rate";
+        EMSESP::analogsensor_.update(35, name, 0, 1, 0, AnalogSensor::AnalogType::RATE);
+        EMSESP::analogsensor_.loop();
+
+        auto value = [](const uint8_t gpio) {
+            for (const auto & sensor : EMSESP::analogsensor_.sensors()) {
+                if (sensor.gpio() == gpio) {
+                    return sensor.value();
+                }
+            }
+            return 0.0;
+        };
+        double counter = value(33);
+
+        // 10Hz, 40ms low, the edges are timed after the sensors were attached
+        uint32_t pulses = id1 > 0 ? id1 : 100;
+        uint32_t t      = PulseCounter::now() + 100;
+        for (uint32_t i = 0; i < pulses; i++, t += 100) {
+            for (const uint8_t gpio : {33, 35}) {
+                EMSESP::analogsensor_.edge(gpio, LOW, t);
+                EMSESP::analogsensor_.edge(gpio, HIGH, t + 1);
+                EMSESP::analogsensor_.edge(gpio, LOW, t + 2);
+                EMSESP::analogsensor_.edge(gpio, HIGH, t + 42);
+                EMSESP::analogsensor_.edge(gpio, LOW, t + 43);
+                EMSESP::analogsensor_.edge(gpio, HIGH, t + 44);
+            }
+        }
+        EMSESP::analogsensor_.loop(); // the first loop after the stall
+
+        uint32_t counted = value(33) - counter;
+        shell.printfln("Counter: %d pulses, %d counted, %s", pulses, counted, counted == pulses ? "OK" : "FAILED");
+        shell.printfln("Rate: %.1f Hz", value(35));
+        ok = true;
+    }
+
+    // settings updates are merged and written once, e.g. "test persistence 50" for 50 updates
+    if (command == "persistence") {
+        shell.printfln("Testing write-behind settings...");
+        FSPersistenceBase::flushAll(); // start without changes pending from earlier tests
+        uint32_t writes  = FSPersistenceBase::writes();
+        uint32_t saved   = FSPersistenceBase::writesSaved();
+        uint32_t updates = id1 > 0 ? id1 : 10;
+
+        for (uint32_t i = 0; i < updates; i++) {
+            EMSESP::webCustomizationService.update([&](WebCustomization & settings) { return StateUpdateResult::CHANGED; });
+        }
+        FSPersistenceBase::loop(); // still within the quiet period
+        uint32_t pending = FSPersistenceBase::writes() - writes;
+        uint32_t merged  = FSPersistenceBase::writesSaved() - saved;
+        shell.printfln("%d updates: %d writes, %d merged, %s", updates, pending, merged, !pending && merged == updates - 1 ? "OK" : "FAILED");
+
+        FSPersistenceBase::flushAll();
+        writes = FSPersistenceBase::writes() - writes;
+        shell.printfln("After flush: %d writes, %s", writes, writes == 1 ? "OK" : "FAILED");
+        ok = true;
+    }
+
+    // benchmarks the translated names in the web device data, e.g. "test translatebench 20" for 20 rounds
+    if (command == "translatebench") {
+        shell.printfln("Benchmarking translations...");
+        uint32_t rounds    = (id1 > 0 ? id1 : 10) * 100;
+        auto     log_level = shell.log_level();
+        shell.log_level(uuid::log::Level::WARNING);
+
+        System::test_set_all_active(true);
+        add_device(0x08, 123); // Nefit Trendline
+        add_device(0x10, 158); // RC300
+        EMSESP::system_.locale("de");
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < rounds; i++) {
+            for (const auto & emsdevice : EMSESP::emsdevices) {
+                JsonDocument doc;
+                emsdevice->generate_values_web(doc.to<JsonObject>());
+            }
+        }
+        uint64_t elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+        uint32_t words = rounds * 10000;
+        start          = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < words; i++) {
+            Helpers::translated_word(FL_(on));
+        }
+        uint64_t elapsed_words = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        shell.log_level(log_level);
+
+        shell.printfln("generate_values_web: %d rounds, %d us per round", rounds, (uint32_t)(elapsed / rounds));
+        shell.printfln("translated_word: %d words, %d ns per word", words, (uint32_t)(elapsed_words * 1000 / words));
+        ok = true;
+    }
+
+    // customizes every entity of a boiler and times the registration of its entities, e.g. "test registerbench 50" for 50 rounds
+    if (command == "registerbench") {
+        shell.printfln("Benchmarking device registration with customizations...");
+        uint32_t rounds    = id1 > 0 ? id1 : 20;
+        auto     log_level = shell.log_level();
+        shell.log_level(uuid::log::Level::WARNING);
+
+        add_device(0x08, 123); // Nefit Trendline
+        auto & boiler = EMSESP::emsdevices.back();
+
+        // mask every entity and give every other one a custom name
+        std::vector<std::string> entity_ids;
+        uint16_t                 i = 0;
+        for (const auto & dv : boiler->devicevalues_) {
+            char name[70];
+            if (dv.tag < DeviceValueTAG::TAG_HC1) {
+                snprintf(name, sizeof(name), "01%s", dv.short_name);
+            } else {
+                snprintf(name, sizeof(name), "01%s/%s", EMSdevice::tag_to_mqtt(dv.tag), dv.short_name);
+            }
+            entity_ids.push_back(i++ % 2 ? std::string(name) + "|custom " + name : name);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        boiler->setCustomizationEntities(entity_ids);
+        uint64_t elapsed_set = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+        std::vector<std::string> stored;
+        start = std::chrono::steady_clock::now();
+        boiler->getCustomizationEntities(stored);
+        uint64_t elapsed_get = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+        EMSESP::webCustomizationService.update([&](WebCustomization & settings) {
+            EntityCustomization entry;
+            entry.product_id = boiler->product_id();
+            entry.device_id  = boiler->device_id();
+            entry.entity_ids = stored;
+            settings.entityCustomizations.push_back(entry);
+            return StateUpdateResult::CHANGED;
+        });
+
+        start = std::chrono::steady_clock::now();
+        for (uint32_t r = 0; r < rounds; r++) {
+            auto device = EMSFactory::add(boiler->device_type(), 0x08, 123, "1.0", boiler->default_name(), boiler->flags(), boiler->brand());
+        }
+        uint64_t elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        shell.log_level(log_level);
+
+        shell.printfln("%d entities, %d customized", boiler->devicevalues_.size(), stored.size());
+        shell.printfln("Set customizations: %d us, get customizations: %d us", (uint32_t)elapsed_set, (uint32_t)elapsed_get);
+        shell.printfln("Registration: %d rounds, %d us per device", rounds, (uint32_t)(elapsed / rounds));
+        ok = true;
+    }
+
+    // dashboard requests during a pending write are answered when the value is read back, or after the timeout
+    if (command == "device_data") {
+        shell.printfln("Testing device_data during a write...");
+        test("boiler");
+        uint8_t               id = EMSESP::emsdevices.front()->unique_id();
+        AsyncWebServerRequest requests[3];
+
+        shell.invoke_command("call boiler dhw.seltemp 52"); // writes UBAParameterWW and reads it back
+        for (auto & request : requests) {
+            EMSESP::webDataService.device_data(&request, id);
+        }
+        shell.printfln("Write pending: %d requests waiting", EMSESP::webDataService.pending_device_data());
+        uart_telegram({0x08, 0x0B, 0x33, 0x00, 0x08, 0xFF, 0x34, 0xFB, 0x00, 0x28, 0x00, 0x00, 0x46, 0x00, 0xFF, 0xFF, 0x00});
+        shell.printfln("Read back: %d requests waiting, validation %s", EMSESP::webDataService.pending_device_data(), EMSESP::wait_validate() ? "pending" : "done");
+
+        shell.invoke_command("call boiler dhw.seltemp 53");
+        for (auto & request : requests) {
+            EMSESP::webDataService.device_data(&request, id);
+        }
+        {
+            AsyncWebServerRequest gone; // a client that disconnects while waiting, its paused request expires
+            EMSESP::webDataService.device_data(&gone, id);
+            shell.printfln("Paused: %s", gone.isPaused() ? "yes" : "no");
+        }
+        shell.printfln("Write pending: %d requests waiting", EMSESP::webDataService.pending_device_data());
+        EMSESP::validate_loop();
+        shell.printfln("No reply yet: %d requests waiting", EMSESP::webDataService.pending_device_data());
+        delay((TxService::POST_SEND_DELAY + 501) * 1000); // uptime is in ms
+        uuid::loop();
+        EMSESP::validate_loop();
+        shell.printfln("Timed out: %d requests waiting, validation %s", EMSESP::webDataService.pending_device_data(), EMSESP::wait_validate() ? "pending" : "done");
+
+        ok = true;
+    }
+#endif
+
+#if defined(EMSESP_STANDALONE) && defined(__GLIBC__)
+    // compares the peak heap of building an MQTT publish packet from a json payload
+    // via an intermediate string versus serializing straight into the packet buffer
+    if (command == "mqtt_heap") {
+        shell.printfln("Measuring MQTT publish heap...");
+        test("memory"); // large boiler and thermostats with all entities
+
+        JsonDocument doc;
+        JsonObject   json = doc.to<JsonObject>();
+        for (const auto & emsdevice : EMSESP::emsdevices) {
+            if (emsdevice->device_type() == EMSdevice::DeviceType::BOILER) {
+                emsdevice->generate_values(json, DeviceValueTAG::TAG_NONE, true, EMSdevice::OUTPUT_TARGET::MQTT);
+            }
+        }
+        const char * topic  = "ems-esp/boiler_data";
+        size_t       length = measureJson(json);
+
+        espMqttClientTypes::Error error;
+        size_t                    base = mallinfo2().uordblks;
+        size_t                    peak_string;
+        size_t                    peak_direct;
+        {
+            std::string payload;
+            payload.reserve(length + 1);
+            serializeJson(json, payload);
+            espMqttClientInternals::Packet packet(error, 1, topic, (const uint8_t *)payload.c_str(), payload.length(), 0, false);
+            peak_string = mallinfo2().uordblks - base;
+        }
+        {
+            espMqttClientInternals::Packet packet(error, 1, topic, length, [&json](uint8_t * data, size_t len) { return serializeJson(json, data, len); }, 0, false);
+            peak_direct = mallinfo2().uordblks - base;
+        }
+
+        shell.printfln("Payload %d bytes", length);
+        shell.printfln("Peak heap with string copy: %d bytes", peak_string);
+        shell.printfln("Peak heap serialized into packet: %d bytes", peak_direct);
+        ok = true;
+    }
+#endif
+
+    // replays a captured telegram stream and times the telegram dispatch
+    // e.g. "test dispatch 1000" to replay 1000 times
+    if (command == "dispatch") {
+        shell.printfln("Benchmarking telegram dispatch...");
+
+        test("2thermostats");
+        test("mixer");
+        EMSESP::watch(EMSESP::Watch::WATCH_OFF); // no logging of each telegram
+
+        // captured from 'watch raw', without CRC
+        std::vector<std::vector<uint8_t>> stream = {
+            {0x08, 0x00, 0x18, 0x00, 0x00, 0x02, 0x5A, 0x73, 0x3D, 0x0A, 0x10, 0x65, 0x40, 0x02, 0x1A,
+             0x80, 0x00, 0x01, 0xE1, 0x01, 0x76, 0x0E, 0x3D, 0x48, 0x00, 0xC9, 0x44, 0x02, 0x00},
+            {0x08, 0x0B, 0x14, 0x00, 0x3C, 0x1F, 0xAC, 0x70},
+            {0x08, 0x0B, 0x33, 0x00, 0x08, 0xFF, 0x34, 0xFB, 0x00, 0x28, 0x00, 0x00, 0x46, 0x00, 0xFF, 0xFF, 0x00},
+            {0x10, 0x00, 0xFF, 0x00, 0x01, 0xA5, 0x80, 0x00, 0x01, 0x30, 0x28, 0x00, 0x30, 0x28, 0x01, 0x54,
+             0x03, 0x03, 0x01, 0x01, 0x54, 0x02, 0xA8, 0x00, 0x00, 0x11, 0x01, 0x03, 0xFF, 0xFF, 0x00},
+            {0x10, 0x00, 0xFF, 0x00, 0x02, 0x1D, 0x00, 0x00, 0x09, 0x07},
+            {0x99, 0x00, 0xFF, 0x00, 0x01, 0xA6, 0x00, 0xCF, 0x21, 0x2E, 0x00, 0x00, 0x2E, 0x24,
+             0x03, 0x25, 0x03, 0x03, 0x01, 0x03, 0x25, 0x00, 0xC8, 0x00, 0x00, 0x11, 0x01, 0x03},
+            {0xA9, 0x00, 0xFF, 0x00, 0x02, 0x32, 0x02, 0x6C, 0x00, 0x3C, 0x00, 0x3C, 0x3C, 0x46, 0x02, 0x03, 0x03, 0x00, 0x3C},
+            {0xA8, 0x00, 0xFF, 0x00, 0x02, 0x31, 0x02, 0x35, 0x00, 0x3C, 0x00, 0x3C, 0x3C, 0x46, 0x02, 0x03, 0x03, 0x00, 0x3C},
+            {0xA0, 0x00, 0xFF, 0x00, 0x01, 0xD7, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x03, 0xC5},
+            {0x08, 0x10, 0x1A, 0x00, 0x00, 0x00, 0x64, 0x00}, // boiler -> master thermostat, no handler
+        };
+
+        uint32_t loops = (id1 > 0) ? id1 : 1000;
+
+        // end-to-end: through the Rx queue and process_telegram()
+        uint8_t data[EMS_MAX_TELEGRAM_LENGTH];
+        auto    start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < loops; i++) {
+            for (const auto & t : stream) {
+                uint8_t len = t.size();
+                memcpy(data, t.data(), len);
+                data[len] = EMSESP::rxservice_.calculate_crc(data, len);
+                EMSESP::rxservice_.add(data, len + 1);
+                EMSESP::rxservice_.loop();
+            }
+        }
+        auto     end     = std::chrono::steady_clock::now();
+        uint64_t elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+        uint32_t count   = loops * stream.size();
+        shell.printfln("Processed %d telegrams in %d ms, %.2f us per telegram", count, (uint32_t)(elapsed / 1000), (float)elapsed / count);
+
+        // resolve (src, type_id) to the device and handler, the old way with linear scans
+        // versus the device_id lookup table and the type_id index
+        std::vector<std::pair<uint8_t, uint16_t>> keys;
+        for (const auto & t : stream) {
+            keys.emplace_back(t[0] & 0x7F, (t[2] == 0xFF) ? ((t[4] << 8) + t[5] + 256) : t[2]);
+        }
+        uint32_t found = 0;
+        start          = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < loops * 100; i++) {
+            for (const auto & k : keys) {
+                for (const auto & emsdevice : EMSESP::emsdevices) {
+                    if (emsdevice->is_device_id(k.first)) {
+                        for (const auto & tf : emsdevice->telegram_functions_) {
+                            if (tf.telegram_type_id_ == k.second) {
+                                found++;
+                                break;
+                            }
+                        }
+                        break;
+                    }
+                }
+            }
+        }
+        end                = std::chrono::steady_clock::now();
+        uint64_t t_linear  = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+        uint32_t found_idx = 0;
+        start              = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < loops * 100; i++) {
+            for (const auto & k : keys) {
+                auto emsdevice = EMSESP::device_dispatch(k.first);
+                if (emsdevice && emsdevice->has_telegram_id(k.second)) {
+                    found_idx++;
+                }
+            }
+        }
+        end               = std::chrono::steady_clock::now();
+        uint64_t t_index  = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+        uint32_t lookups  = loops * 100 * keys.size();
+        shell.printfln("Linear lookup:  %d lookups (%d found) in %d ms, %.1f ns per lookup",
+                       lookups,
+                       found,
+                       (uint32_t)(t_linear / 1000),
+                       (float)t_linear * 1000 / lookups);
+        shell.printfln("Indexed lookup: %d lookups (%d found) in %d ms, %.1f ns per lookup",
+                       lookups,
+                       found_idx,
+                       (uint32_t)(t_index / 1000),
+                       (float)t_index * 1000 / lookups);
+
+        ok = true;
+    }
+
     if (command == "web") {
         shell.printfln("Testing Web...");
 
@@ -973,8 +1506,7 @@ void Test::run_test(uuid::console::Shell & shell, const std::string & cmd, const
                 Serial.print(emsdevice->device_type_name());
                 Serial.print(" uniqueid=");
                 Serial.println(emsdevice->unique_id());
-                std::string a = "00hc1/seltemp|new name>5<52";
-                emsdevice->setCustomizationEntity(a);
+                emsdevice->setCustomizationEntities({"00hc1/seltemp|new name>5<52"});
                 break;
             }
         }
@@ -999,8 +1531,7 @@ void Test::run_test(uuid::console::Shell & shell, const std::string & cmd, const
         // toggle mode
         for (const auto & emsdevice : EMSESP::emsdevices) {
             if (emsdevice->unique_id() == 1) { // boiler
-                std::string a = "07wwseltemp";
-                emsdevice->setCustomizationEntity(a);
+                emsdevice->setCustomizationEntities({"07wwseltemp"});
                 break;
             }
         }
@@ -2048,6 +2579,12 @@ void Test::run_test(uuid::console::Shell & shell, const std::string & cmd, const
 
         EMSESP::publish_all(true);
 
+        // on-change publish, only the tags with changed values are sent. Change hc1 seltemp, so no thermostat_data topic
+        Mqtt::nested_format(2); // not nested
+        uart_telegram("98 00 FF 00 01 A5 00 CF 21 2E 00 00 30 24 03 25 03 03 01 03 25 00 C8 00 00 11 01 03");
+        EMSESP::publish_device_values(EMSdevice::DeviceType::THERMOSTAT, true);
+        Mqtt::nested_format(1);
+
         Mqtt::resubscribe();
         Mqtt::show_mqtt(shell); // show queue
         ok = true;
@@ -2250,6 +2787,72 @@ void Test::run_test(uuid::console::Shell & shell, const std::string & cmd, const
             }
         }
 
+        // handleRead of a block of registers, and the number of requests needed to read all entities
+        {
+            shell.println();
+            shell.printfln("Testing modbus->handleRead() with register blocks:");
+
+            // collect the register ranges of all mapped entities, per device type and tag
+            std::map<std::pair<uint8_t, int8_t>, std::vector<std::pair<uint16_t, uint16_t>>> registers;
+            for (const auto & dev : {boiler_dev.get(), thermostat_dev.get()}) {
+                for (const auto & dv : dev->devicevalues_) {
+                    auto offset = EMSESP::modbus_->getRegisterOffset(dv);
+                    auto count  = EMSESP::modbus_->getRegisterCount(dv);
+                    if (offset >= 0 && count > 0) {
+                        registers[{dev->device_type(), dv.tag}].emplace_back(offset, count);
+                    }
+                }
+            }
+
+            uint32_t single_requests = 0;
+            uint32_t block_requests  = 0;
+            uint32_t block_errors    = 0;
+            auto     start           = std::chrono::steady_clock::now();
+            for (auto & r : registers) {
+                auto & ranges = r.second;
+                std::sort(ranges.begin(), ranges.end());
+                single_requests += ranges.size();
+
+                // pack consecutive entities into requests of up to MAX_READ_REGISTERS
+                size_t i = 0;
+                while (i < ranges.size()) {
+                    uint16_t first = ranges[i].first;
+                    uint16_t last  = first + ranges[i].second;
+                    while (++i < ranges.size() && ranges[i].first + ranges[i].second - first <= Modbus::MAX_READ_REGISTERS) {
+                        last = ranges[i].first + ranges[i].second;
+                    }
+                    uint16_t      reg       = Modbus::REGISTER_BLOCK_SIZE * r.first.second + first;
+                    uint16_t      num_words = last - first;
+                    ModbusMessage request({r.first.first,
+                                           0x03,
+                                           static_cast<unsigned char>(reg >> 8),
+                                           static_cast<unsigned char>(reg & 0xff),
+                                           static_cast<unsigned char>(num_words >> 8),
+                                           static_cast<unsigned char>(num_words & 0xff)});
+                    auto          response = EMSESP::modbus_->handleRead(request);
+                    block_requests++;
+                    if (response.getError() != SUCCESS || response._data.size() != 3U + num_words * 2) {
+                        shell.printfln("block read at %d with %d registers [ERROR %d]", reg, num_words, response.getError());
+                        block_errors++;
+                    }
+                }
+            }
+            auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+            shell.printfln("Full scrape of %d entities: %d requests reading single values, %d requests reading blocks (%d us) %s",
+                           single_requests,
+                           single_requests,
+                           block_requests,
+                           (uint32_t)elapsed,
+                           block_errors ? "[ERROR]" : "[OK]");
+
+            // a block starting in the middle of an entity must fail. lastcode is at offset 36 with 28 registers
+            uint16_t      reg = Modbus::REGISTER_BLOCK_SIZE * DeviceValueTAG::TAG_DEVICE_DATA + 37;
+            ModbusMessage request({boiler_dev->device_type(), 0x03, static_cast<unsigned char>(reg >> 8), static_cast<unsigned char>(reg & 0xff), 0, 10});
+            auto          response = EMSESP::modbus_->handleRead(request);
+            shell.printfln("block read in the middle of an entity %s", response.getError() == ILLEGAL_DATA_ADDRESS ? "[OK]" : "[ERROR]");
+        }
+
         // handleWrite boiler
         {
             shell.println();
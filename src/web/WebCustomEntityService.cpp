@@ -142,9 +142,11 @@ StateUpdateResult WebCustomEntity::update(JsonObject root, WebCustomEntity & web
             }
 
             if (entityItem.ram && doc[entityItem.name].is<JsonVariantConst>() && doc[entityItem.name] != entityItem.value) {
-                char cmd[COMMAND_MAX_LENGTH];
-                snprintf(cmd, sizeof(cmd), "%s/%s", F_(custom), entityItem.name.c_str());
-                EMSESP::webSchedulerService.onChange(cmd);
+                if (EMSESP::webSchedulerService.has_subscriptions()) {
+                    char cmd[COMMAND_MAX_LENGTH];
+                    snprintf(cmd, sizeof(cmd), "%s/%s", F_(custom), entityItem.name.c_str());
+                    EMSESP::webSchedulerService.onChange(cmd);
+                }
             }
         }
     }
@@ -206,9 +208,11 @@ bool WebCustomEntityService::command_setvalue(const char * value, const int8_t i
             if (EMSESP::mqtt_.get_publish_onchange(0)) {
                 publish();
             }
-            char cmd[COMMAND_MAX_LENGTH];
-            snprintf(cmd, sizeof(cmd), "%s/%s", F_(custom), entityItem.name.c_str());
-            EMSESP::webSchedulerService.onChange(cmd);
+            if (EMSESP::webSchedulerService.has_subscriptions()) {
+                char cmd[COMMAND_MAX_LENGTH];
+                snprintf(cmd, sizeof(cmd), "%s/%s", F_(custom), entityItem.name.c_str());
+                EMSESP::webSchedulerService.onChange(cmd);
+            }
             return true;
         }
     }
@@ -640,9 +644,11 @@ bool WebCustomEntityService::get_value(std::shared_ptr<const Telegram> telegram)
                     } else if (EMSESP::mqtt_.get_publish_onchange(0)) {
                         has_change = true;
                     }
-                    char cmd[COMMAND_MAX_LENGTH];
-                    snprintf(cmd, sizeof(cmd), "%s/%s", F_(custom), entity.name.c_str());
-                    EMSESP::webSchedulerService.onChange(cmd);
+                    if (EMSESP::webSchedulerService.has_subscriptions()) {
+                        char cmd[COMMAND_MAX_LENGTH];
+                        snprintf(cmd, sizeof(cmd), "%s/%s", F_(custom), entity.name.c_str());
+                        EMSESP::webSchedulerService.onChange(cmd);
+                    }
                 }
             }
         } else if (entity.value_type != DeviceValueType::STRING && telegram->type_id == entity.type_id && telegram->src == entity.device_id
@@ -662,9 +668,11 @@ bool WebCustomEntityService::get_value(std::shared_ptr<const Telegram> telegram)
                 } else if (EMSESP::mqtt_.get_publish_onchange(0)) {
                     has_change = true;
                 }
-                char cmd[COMMAND_MAX_LENGTH];
-                snprintf(cmd, sizeof(cmd), "%s/%s", F_(custom), entity.name.c_str());
-                EMSESP::webSchedulerService.onChange(cmd);
+                if (EMSESP::webSchedulerService.has_subscriptions()) {
+                    char cmd[COMMAND_MAX_LENGTH];
+                    snprintf(cmd, sizeof(cmd), "%s/%s", F_(custom), entity.name.c_str());
+                    EMSESP::webSchedulerService.onChange(cmd);
+                }
             }
             // EMSESP::logger().debug("custom entity %s received with value %d", entity.name.c_str(), (int)entity.val);
         }
@@ -287,15 +287,17 @@ void WebCustomizationService::customization_entities(AsyncWebServerRequest * req
                     // and set the mask and custom names immediately for any listed entities
                     JsonArray                entity_ids_json = json["entity_ids"];
                     std::vector<std::string> entity_ids;
+                    std::vector<std::string> custom_ids;
                     for (const JsonVariant id : entity_ids_json) {
                         std::string id_s = id.as<std::string>();
                         if (id_s[0] == '8') {
                             entity_ids.push_back(id_s);
                             need_reboot = true;
                         } else {
-                            emsdevice->setCustomizationEntity(id_s);
+                            custom_ids.push_back(id_s);
                         }
                     }
+                    emsdevice->setCustomizationEntities(custom_ids);
 
                     // add deleted entities from file
                     read([&](WebCustomization & settings) {
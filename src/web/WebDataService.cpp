@@ -163,58 +163,82 @@ void WebDataService::sensor_data(AsyncWebServerRequest * request) {
 // endpoint /rest/deviceData?id=n
 // Compresses the JSON using MsgPack https://msgpack.org/index.html
 void WebDataService::device_data(AsyncWebServerRequest * request) {
-    uint8_t id;
     if (request->hasParam(F_(id))) {
-        id = Helpers::atoint(request->getParam(F_(id))->value().c_str()); // get id from url
-
-        auto * response = new AsyncMessagePackResponse();
-
-        // check size
-        // while (!response) {
-        //     delete response;
-        //     buffer -= 1024;
-        //     response = new MsgpackAsyncJsonResponse(false, buffer);
-        // }
-
-        for (const auto & emsdevice : EMSESP::emsdevices) {
-            if (emsdevice->unique_id() == id) {
-                // wait max 2.5 sec for updated data (post_send_delay is 2 sec)
-                for (uint16_t i = 0; i < (emsesp::TxService::POST_SEND_DELAY + 500) && EMSESP::wait_validate(); i++) {
-                    delay(1);
-                }
-                EMSESP::wait_validate(0); // reset in case of timeout
-#ifndef EMSESP_STANDALONE
-                JsonObject output = response->getRoot();
-                emsdevice->generate_values_web(output);
-#endif
+        device_data(request, Helpers::atoint(request->getParam(F_(id))->value().c_str())); // get id from url
+        return;
+    }
 
-#if defined(EMSESP_DEBUG)
-                size_t length = response->setLength();
-                EMSESP::logger().debug("Dashboard buffer used: %d", length);
-#else
-                response->setLength();
-#endif
-                request->send(response);
-                return;
-            }
+    // invalid
+    AsyncWebServerResponse * response = request->beginResponse(400); // bad request
+    request->send(response);
+}
+
+// while a write is waiting to be read back the request is paused and answered when the new value arrived or the wait timed out,
+// so the web server task is not blocked for the other clients
+void WebDataService::device_data(AsyncWebServerRequest * request, const uint8_t id) {
+    if (EMSESP::wait_validate() && id != EMSdevice::DeviceTypeUniqueID::CUSTOM_UID) {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        // a non-empty list already has its callback registered
+        if (!pending_device_data_.empty() || EMSESP::on_validate([this] { send_pending_device_data(); })) {
+            pending_device_data_.emplace_back(request->pause(), id);
+            return;
         }
+    }
+
+    send_device_data(request, id);
+}
 
+void WebDataService::send_device_data(AsyncWebServerRequest * request, const uint8_t id) {
+    for (const auto & emsdevice : EMSESP::emsdevices) {
+        if (emsdevice->unique_id() == id) {
+            auto * response = new AsyncMessagePackResponse();
 #ifndef EMSESP_STANDALONE
-        if (id == EMSdevice::DeviceTypeUniqueID::CUSTOM_UID) {
             JsonObject output = response->getRoot();
-            EMSESP::webCustomEntityService.generate_value_web(output);
+            emsdevice->generate_values_web(output);
+#endif
+
+#if defined(EMSESP_DEBUG)
+            size_t length = response->setLength();
+            EMSESP::logger().debug("Dashboard buffer used: %d", length);
+#else
             response->setLength();
+#endif
             request->send(response);
             return;
         }
-#endif
     }
 
+#ifndef EMSESP_STANDALONE
+    if (id == EMSdevice::DeviceTypeUniqueID::CUSTOM_UID) {
+        auto *     response = new AsyncMessagePackResponse();
+        JsonObject output   = response->getRoot();
+        EMSESP::webCustomEntityService.generate_value_web(output);
+        response->setLength();
+        request->send(response);
+        return;
+    }
+#endif
+
     // invalid
     AsyncWebServerResponse * response = request->beginResponse(400); // bad request
     request->send(response);
 }
 
+// called from the loop when the validation is done or timed out
+// a locked request stays alive while it is answered, requests of clients that are gone have expired
+void WebDataService::send_pending_device_data() {
+    std::vector<std::pair<AsyncWebServerRequestPtr, uint8_t>> pending;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        pending.swap(pending_device_data_);
+    }
+    for (const auto & p : pending) {
+        if (auto request = p.first.lock()) {
+            send_device_data(request.get(), p.second);
+        }
+    }
+}
+
 // assumes the service has been checked for admin authentication
 void WebDataService::write_device_value(AsyncWebServerRequest * request, JsonVariant json) {
     if (json.is<JsonObject>()) {
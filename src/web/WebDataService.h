@@ -45,12 +45,26 @@ class WebDataService {
     void core_data(AsyncWebServerRequest * request);
     void sensor_data(AsyncWebServerRequest * request);
     void device_data(AsyncWebServerRequest * request);
+    void device_data(AsyncWebServerRequest * request, const uint8_t id);
     void dashboard_data(AsyncWebServerRequest * request);
 
+    // device_data requests waiting for a write to be read back
+    size_t pending_device_data() {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        return pending_device_data_.size();
+    }
+
     // POST
     void write_device_value(AsyncWebServerRequest * request, JsonVariant json);
     void write_temperature_sensor(AsyncWebServerRequest * request, JsonVariant json);
     void write_analog_sensor(AsyncWebServerRequest * request, JsonVariant json);
+
+  private:
+    void send_device_data(AsyncWebServerRequest * request, const uint8_t id);
+    void send_pending_device_data();
+
+    std::mutex                                                pending_mutex_;       // requests come from the web server task, answers from the loop
+    std::vector<std::pair<AsyncWebServerRequestPtr, uint8_t>> pending_device_data_; // paused requests, expired when the client is gone
 };
 
 } // namespace emsesp
@@ -37,18 +37,19 @@ WebLogService::WebLogService(AsyncWebServer * server, SecurityManager * security
 
 // start the log service with INFO level
 void WebLogService::begin() {
+    batch_.resize(SSE_BATCH_SIZE + 3); // brackets and terminator
+    resize(maximum_log_messages_);
     uuid::log::Logger::register_handler(this, uuid::log::Level::INFO);
 }
 
 // apply the user settings
 void WebLogService::start() {
     EMSESP::webSettingsService.read([&](WebSettings & settings) {
-        maximum_log_messages_ = settings.weblog_buffer;
-        limit_log_messages_   = maximum_log_messages_;
-        compact_              = settings.weblog_compact;
+        resize(std::max((size_t)1, (size_t)settings.weblog_buffer));
+        compact_ = settings.weblog_compact;
         uuid::log::Logger::register_handler(this, (uuid::log::Level)settings.weblog_level);
         if ((uuid::log::Level)settings.weblog_level == uuid::log::Level::OFF) {
-            log_messages_.clear();
+            clear();
         }
     });
 }
@@ -64,12 +65,12 @@ void WebLogService::log_level(uuid::log::Level level) {
     });
     uuid::log::Logger::register_handler(this, level);
     if (level == uuid::log::Level::OFF) {
-        log_messages_.clear();
+        clear();
     }
 }
 
 size_t WebLogService::num_log_messages() const {
-    return log_messages_.size();
+    return ring_count_;
 }
 
 size_t WebLogService::maximum_log_messages() const {
@@ -77,15 +78,7 @@ size_t WebLogService::maximum_log_messages() const {
 }
 
 void WebLogService::maximum_log_messages(size_t count) {
-    maximum_log_messages_ = std::max((size_t)1, count);
-
-    if (limit_log_messages_ > maximum_log_messages_) {
-        limit_log_messages_ = maximum_log_messages_;
-    }
-
-    while (log_messages_.size() > maximum_log_messages_) {
-        log_messages_.pop_front();
-    }
+    resize(std::max((size_t)1, count));
 
     EMSESP::webSettingsService.update([&](WebSettings & settings) {
         settings.weblog_buffer = count;
@@ -105,30 +98,100 @@ void WebLogService::compact(bool compact) {
     });
 }
 
-WebLogService::QueuedLogMessage::QueuedLogMessage(unsigned long id, std::shared_ptr<uuid::log::Message> && content)
-    : id_(id)
-    , content_(std::move(content)) {
+void WebLogService::operator<<(const uuid::log::Message & message) {
+    char      json[MAX_ENTRY_SIZE];
+    LogRecord rec;
+    rec.id     = ++log_message_id_;
+    rec.level  = message.level;
+    rec.length = serialize(json, message, rec.id);
+    push(rec, json);
+}
+
+// copy in and out of the ring, wrapping at the end
+static void ring_write(std::vector<char> & ring, size_t pos, const void * data, size_t len) {
+    pos %= ring.size();
+    size_t first = std::min(len, ring.size() - pos);
+    memcpy(&ring[pos], data, first);
+    memcpy(&ring[0], (const char *)data + first, len - first);
+}
+
+static void ring_read(const std::vector<char> & ring, size_t pos, void * data, size_t len) {
+    pos %= ring.size();
+    size_t first = std::min(len, ring.size() - pos);
+    memcpy(data, &ring[pos], first);
+    memcpy((char *)data + first, &ring[0], len - first);
+}
+
+WebLogService::LogRecord WebLogService::record(const size_t pos) const {
+    LogRecord rec;
+    ring_read(ring_, pos, &rec, sizeof(rec));
+    return rec;
+}
+
+// adds a message, dropping the oldest ones until it fits
+void WebLogService::push(const LogRecord & rec, const char * json) {
+    if (ring_.empty()) {
+        return;
+    }
+    size_t size = sizeof(rec) + rec.length;
+    while (ring_count_ && (ring_count_ >= maximum_log_messages_ || ring_used_ + size > ring_.size())) {
+        pop();
+    }
+    size_t pos = ring_head_ + ring_used_;
+    ring_write(ring_, pos, &rec, sizeof(rec));
+    ring_write(ring_, pos + sizeof(rec), json, rec.length);
+    ring_used_ += size;
+    ring_count_++;
+}
+
+void WebLogService::pop() {
+    size_t size = sizeof(LogRecord) + record(ring_head_).length;
+    ring_head_  = (ring_head_ + size) % ring_.size();
+    ring_used_ -= size;
+    ring_count_--;
 }
 
-void WebLogService::operator<<(std::shared_ptr<uuid::log::Message> message) {
+void WebLogService::clear() {
+    ring_head_  = 0;
+    ring_used_  = 0;
+    ring_count_ = 0;
+}
+
+// sets the maximum number of messages and sizes the ring for it, keeping the newest messages that fit
+// without PSRAM the ring is capped, so a large buffer setting holds fewer messages instead of taking the heap
+void WebLogService::resize(const size_t count) {
+    size_t size = count * LOG_ENTRY_SIZE;
 #ifndef EMSESP_STANDALONE
-    size_t maxAlloc = ESP.getMaxAllocHeap();
-    if (limit_log_messages_ > 5 && maxAlloc < 46080) {
-        --limit_log_messages_;
-    } else if (limit_log_messages_ < maximum_log_messages_ && maxAlloc > 51200) {
-        ++limit_log_messages_;
+    if (!ESP.getPsramSize()) {
+        size = std::min(size, MAX_RING_SIZE);
     }
 #endif
-    while (log_messages_.size() >= limit_log_messages_) {
-        log_messages_.pop_front();
+    size = std::max(size, sizeof(LogRecord) + MAX_ENTRY_SIZE);
+    if (size == ring_.size()) {
+        maximum_log_messages_ = count;
+        return;
     }
 
-    log_messages_.emplace_back(++log_message_id_, std::move(message));
+    std::vector<char> old(size);
+    old.swap(ring_);
+    size_t head  = ring_head_;
+    size_t total = ring_count_;
+    clear();
+    maximum_log_messages_ = count;
+
+    char json[MAX_ENTRY_SIZE];
+    for (size_t i = 0; i < total; i++) {
+        LogRecord rec;
+        ring_read(old, head, &rec, sizeof(rec));
+        ring_read(old, head + sizeof(rec), json, rec.length);
+        head = (head + sizeof(rec) + rec.length) % old.size();
+        push(rec, json);
+    }
 }
 
 // dumps out the contents of log buffer to shell console
 void WebLogService::show(Shell & shell) {
-    if (log_messages_.empty()) {
+    if (!ring_count_) {
         return;
     }
 
@@ -136,59 +199,87 @@ void WebLogService::show(Shell & shell) {
     shell.printfln("Recent Log (level %s, max %d messages):", format_level_uppercase(log_level()), maximum_log_messages());
     shell.println();
 
-    for (const auto & message : log_messages_) {
-        log_message_id_tail_ = message.id_;
+    char         json[MAX_ENTRY_SIZE];
+    JsonDocument doc;
+    size_t       pos = ring_head_;
+    for (size_t i = 0; i < ring_count_; i++) {
+        LogRecord rec = record(pos);
+        ring_read(ring_, pos + sizeof(rec), json, rec.length);
+        pos                  = (pos + sizeof(rec) + rec.length) % ring_.size();
+        log_message_id_tail_ = rec.id;
+        if (deserializeJson(doc, json, rec.length)) {
+            continue;
+        }
 
-        char time_string[26];
-        shell.print(messagetime(time_string, message.content_->uptime_ms, sizeof(time_string)));
-        shell.printf(" %c %lu: [%s] ", uuid::log::format_level_char(message.content_->level), message.id_, message.content_->name);
+        shell.print(doc["t"].as<const char *>());
+        shell.printf(" %c %lu: [%s] ", uuid::log::format_level_char((uuid::log::Level)rec.level), (unsigned long)rec.id, doc["n"].as<const char *>());
 
-        if ((message.content_->level == uuid::log::Level::ERR) || (message.content_->level == uuid::log::Level::WARNING)) {
+        if ((rec.level == uuid::log::Level::ERR) || (rec.level == uuid::log::Level::WARNING)) {
             shell.print(COLOR_RED);
-            shell.println(message.content_->text);
+            shell.println(doc["m"].as<const char *>());
             shell.print(COLOR_RESET);
-        } else if (message.content_->level == uuid::log::Level::INFO) {
+        } else if (rec.level == uuid::log::Level::INFO) {
             shell.print(COLOR_YELLOW);
-            shell.println(message.content_->text);
+            shell.println(doc["m"].as<const char *>());
             shell.print(COLOR_RESET);
-        } else if (message.content_->level == uuid::log::Level::DEBUG) {
+        } else if (rec.level == uuid::log::Level::DEBUG) {
             shell.print(COLOR_CYAN);
-            shell.println(message.content_->text);
+            shell.println(doc["m"].as<const char *>());
             shell.print(COLOR_RESET);
         } else {
-            shell.println(message.content_->text);
+            shell.println(doc["m"].as<const char *>());
         }
     }
 
     shell.println();
 }
 
+// sends the new messages as json arrays, up to SSE_FLUSH_SIZE bytes per loop
 void WebLogService::loop() {
-    if (!events_.count() || log_messages_.empty() || events_.avgPacketsWaiting() >= SSE_MAX_QUEUED_MESSAGES) {
-        return;
-    }
+    size_t sent = 0;
+    while (sent < SSE_FLUSH_SIZE && events_.count() && ring_count_ && events_.avgPacketsWaiting() < SSE_MAX_QUEUED_MESSAGES) {
+        // see if we've advanced
+        if (log_message_id_ <= log_message_id_tail_) {
+            return;
+        }
 
-    // see if we've advanced
-    if (log_messages_.back().id_ <= log_message_id_tail_) {
-        return;
-    }
+        /*
+        // put a small delay in - https://github.com/emsesp/EMS-ESP32/issues/1652
+        if (uuid::get_uptime_ms() - last_transmit_ < REFRESH_SYNC) {
+            return;
+        }
+        last_transmit_ = uuid::get_uptime_ms();
+        */
 
-    /*
-    // put a small delay in - https://github.com/emsesp/EMS-ESP32/issues/1652
-    if (uuid::get_uptime_ms() - last_transmit_ < REFRESH_SYNC) {
-        return;
+        sent += transmit();
     }
-    last_transmit_ = uuid::get_uptime_ms();
-    */
-
-    // flush
-    for (const auto & message : log_messages_) {
-        if (message.id_ > log_message_id_tail_) {
-            log_message_id_tail_ = message.id_;
-            transmit(message);
-            return;
+}
+
+// sends the oldest unsent messages in one event, as many as fit in SSE_BATCH_SIZE
+size_t WebLogService::transmit() {
+    size_t len = 0;
+    size_t pos = ring_head_;
+    batch_[len++] = '[';
+    for (size_t i = 0; i < ring_count_; i++) {
+        LogRecord rec = record(pos);
+        if (rec.id > log_message_id_tail_) {
+            if (len > 1) {
+                if (len + rec.length >= SSE_BATCH_SIZE) {
+                    break;
+                }
+                batch_[len++] = ',';
+            }
+            ring_read(ring_, pos + sizeof(rec), &batch_[len], rec.length);
+            len += rec.length;
+            log_message_id_tail_ = rec.id;
         }
+        pos = (pos + sizeof(rec) + rec.length) % ring_.size();
     }
+    batch_[len++] = ']';
+    batch_[len]   = '\0';
+
+    events_.send(batch_.data(), "message", log_message_id_tail_);
+    return len;
 }
 
 // convert time to real offset
@@ -205,26 +296,46 @@ char * WebLogService::messagetime(char * out, const uint64_t t, const size_t buf
     return out;
 }
 
-// send to web eventsource
-void WebLogService::transmit(const QueuedLogMessage & message) {
-    JsonDocument jsonDocument;
-
-    JsonObject logEvent = jsonDocument.to<JsonObject>();
-    char       time_string[25];
-
-    logEvent["t"] = messagetime(time_string, message.content_->uptime_ms, sizeof(time_string));
-    logEvent["l"] = message.content_->level;
-    logEvent["i"] = message.id_;
-    logEvent["n"] = message.content_->name;
-    logEvent["m"] = message.content_->text;
-
-    size_t len    = measureJson(jsonDocument);
-    char * buffer = new char[len + 1];
-    if (buffer) {
-        serializeJson(jsonDocument, buffer, len + 1);
-        events_.send(buffer, "message", message.id_);
+// appends a json string without quotes, stops before a character that doesn't fit
+static size_t json_escape(char * out, size_t len, const size_t size, const char * text) {
+    for (const char * c = text; *c; c++) {
+        char   esc[7];
+        size_t n = 0;
+        if (*c == '"' || *c == '\\') {
+            esc[n++] = '\\';
+            esc[n++] = *c;
+        } else if ((uint8_t)*c < 0x20) {
+            n = snprintf(esc, sizeof(esc), "\\u%04x", *c);
+        } else {
+            esc[n++] = *c;
+        }
+        if (len + n >= size) {
+            break;
+        }
+        memcpy(out + len, esc, n);
+        len += n;
     }
-    delete[] buffer;
+    return len;
+}
+
+// the json sent to the web eventsource, done once when the message is logged
+size_t WebLogService::serialize(char * out, const uuid::log::Message & message, const uint32_t id) {
+    constexpr size_t tail = 3; // closing "} and terminator
+    char             time_string[25];
+
+    size_t len = snprintf(out,
+                          MAX_ENTRY_SIZE,
+                          "{\"t\":\"%s\",\"l\":%d,\"i\":%lu,\"n\":\"",
+                          messagetime(time_string, message.uptime_ms, sizeof(time_string)),
+                          message.level,
+                          (unsigned long)id);
+    len = json_escape(out, len, MAX_ENTRY_SIZE - tail - 7, message.name);
+    len += snprintf(out + len, MAX_ENTRY_SIZE - len, "\",\"m\":\"");
+    len = json_escape(out, len, MAX_ENTRY_SIZE - tail, message.text);
+    out[len++] = '"';
+    out[len++] = '}';
+    out[len]   = '\0';
+    return len;
 }
 
 // sets the values after a POST
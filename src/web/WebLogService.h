@@ -29,6 +29,11 @@ namespace emsesp {
 class WebLogService : public uuid::log::Handler {
   public:
     static constexpr size_t MAX_LOG_MESSAGES = 25;
+    static constexpr size_t LOG_ENTRY_SIZE   = 192;                // average size of a serialized message, sizes the buffer
+    static constexpr size_t MAX_ENTRY_SIZE   = 512;                // longer messages are cut off
+    static constexpr size_t MAX_RING_SIZE    = MAX_LOG_MESSAGES * LOG_ENTRY_SIZE; // bytes, caps the buffer on boards without PSRAM
+    static constexpr size_t SSE_BATCH_SIZE   = 1436;               // max bytes of messages in one event, fits a TCP segment with the SSE framing
+    static constexpr size_t SSE_FLUSH_SIZE   = 4 * SSE_BATCH_SIZE; // max bytes sent per loop
     // static constexpr size_t REFRESH_SYNC     = 30;
 
     WebLogService(AsyncWebServer * server, SecurityManager * securityManager);
@@ -45,32 +50,43 @@ class WebLogService : public uuid::log::Handler {
     void             loop();
     void             show(Shell & shell);
 
-    virtual void operator<<(std::shared_ptr<uuid::log::Message> message);
+#if defined(EMSESP_STANDALONE)
+    AsyncEventSource & events() {
+        return events_;
+    }
+#endif
+
+    virtual void operator<<(const uuid::log::Message & message);
 
   private:
     AsyncEventSource events_;
 
-    class QueuedLogMessage {
-      public:
-        QueuedLogMessage(unsigned long id, std::shared_ptr<uuid::log::Message> && content);
-        ~QueuedLogMessage() = default;
-
-        unsigned long                                   id_;      // Sequential identifier for this log message
-        struct timeval                                  time_;    // Time message was received
-        const std::shared_ptr<const uuid::log::Message> content_; // Log message content
+    // log messages are kept as the json sent to the web UI, each behind this header in a byte ring
+    struct LogRecord {
+        uint32_t id; // Sequential identifier for this log message
+        uint16_t length;
+        uint8_t  level;
     };
 
-    void transmit(const QueuedLogMessage & message);
-    void getSetValues(AsyncWebServerRequest * request, JsonVariant json);
-
-    char * messagetime(char * out, const uint64_t t, const size_t bufsize);
-
-    size_t                       maximum_log_messages_ = MAX_LOG_MESSAGES; // Maximum number of log messages to buffer before they are output
-    size_t                       limit_log_messages_   = 1;                // dynamic limit
-    unsigned long                log_message_id_       = 0;                // The next identifier to use for queued log messages
-    unsigned long                log_message_id_tail_  = 0;                // last event shown on the screen after fetch
-    std::deque<QueuedLogMessage> log_messages_;                            // Queued log messages, in the order they were received
-    bool                         compact_ = true;
+    size_t    transmit();
+    void      getSetValues(AsyncWebServerRequest * request, JsonVariant json);
+    char *    messagetime(char * out, const uint64_t t, const size_t bufsize);
+    size_t    serialize(char * out, const uuid::log::Message & message, const uint32_t id);
+    void      push(const LogRecord & record, const char * json);
+    void      pop();
+    void      clear();
+    void      resize(const size_t count);
+    LogRecord record(const size_t pos) const;
+
+    size_t            maximum_log_messages_ = MAX_LOG_MESSAGES; // Maximum number of log messages to buffer before they are output
+    unsigned long     log_message_id_       = 0;                // The next identifier to use for queued log messages
+    unsigned long     log_message_id_tail_  = 0;                // last event shown on the screen after fetch
+    std::vector<char> ring_;                                    // fixed size, LOG_ENTRY_SIZE per message
+    size_t            ring_head_  = 0;                          // offset of the oldest record
+    size_t            ring_used_  = 0;                          // bytes in use
+    size_t            ring_count_ = 0;                          // records in use
+    std::vector<char> batch_;                                   // the event being sent, a json array of messages
+    bool              compact_ = true;
 };
 
 } // namespace emsesp
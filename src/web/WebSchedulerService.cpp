@@ -22,6 +22,8 @@
 
 namespace emsesp {
 
+#include "shuntingYard.hpp"
+
 WebSchedulerService::WebSchedulerService(AsyncWebServer * server, FS * fs, SecurityManager * securityManager)
     : _httpEndpoint(WebScheduler::read, WebScheduler::update, this, server, EMSESP_SCHEDULER_SERVICE_PATH, securityManager, AuthenticationPredicates::IS_AUTHENTICATED)
     , _fsPersistence(WebScheduler::read, WebScheduler::update, this, fs, EMSESP_SCHEDULER_FILE) {
@@ -74,6 +76,7 @@ StateUpdateResult WebScheduler::update(JsonObject root, WebScheduler & webSchedu
     Command::erase_device_commands(EMSdevice::DeviceType::SCHEDULER);
     webScheduler.scheduleItems.clear();
     EMSESP::webSchedulerService.ha_reset();
+    clear_expression_cache();
 
     // build up the list of schedule items
     auto scheduleItems = root["schedule"].as<JsonArray>();
@@ -105,6 +108,7 @@ StateUpdateResult WebScheduler::update(JsonObject root, WebScheduler & webSchedu
         }
     }
 
+    EMSESP::webSchedulerService.build_subscriptions(webScheduler.scheduleItems);
     EMSESP::webSchedulerService.publish(true);
 
     return StateUpdateResult::CHANGED;
@@ -321,8 +325,6 @@ uint8_t WebSchedulerService::count_entities(bool cmd_only) {
     return count;
 }
 
-#include "shuntingYard.hpp"
-
 // execute scheduled command
 bool WebSchedulerService::command(const char * name, const std::string & command, const std::string & data) {
     std::string cmd = Helpers::toLower(command);
@@ -418,17 +420,58 @@ bool WebSchedulerService::command(const char * name, const std::string & command
     return false;
 }
 
+// case-insensitive FNV-1a hash of an entity path
+uint32_t WebSchedulerService::subscription_hash(const char * path, size_t len) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash ^ (uint8_t)tolower(path[i])) * 16777619u;
+    }
+    return hash;
+}
+
+// map the entity paths of all onChange schedules to their schedule items
+// the time field may hold several paths separated by spaces, commas or semicolons
+// paths are keyed lowercase and without a trailing /value, so boiler/outdoortemp/value watches boiler/outdoortemp
+// called when the schedules are loaded or saved
+void WebSchedulerService::build_subscriptions(std::list<ScheduleItem> & scheduleItems) {
+    subscriptions_.clear();
+    cmd_changed_.clear(); // the queued items are gone
+    for (ScheduleItem & scheduleItem : scheduleItems) {
+        if (scheduleItem.flags != SCHEDULEFLAG_SCHEDULE_ONCHANGE) {
+            continue;
+        }
+        const char * p = scheduleItem.time.c_str();
+        while (*p) {
+            size_t len  = strcspn(p, " ,;");
+            auto   path = Helpers::toLower(std::string(p, len));
+            if (path.length() > 6 && path.compare(path.length() - 6, 6, "/value") == 0) {
+                path.resize(path.length() - 6);
+            }
+            if (!path.empty()) {
+                auto hash = subscription_hash(path.c_str(), path.length());
+                auto it   = subscriptions_.equal_range(hash);
+                if (std::none_of(it.first, it.second, [&](const auto & s) { return s.second.scheduleItem == &scheduleItem && s.second.path == path; })) {
+                    subscriptions_.emplace(hash, Subscription{path, &scheduleItem});
+                }
+            }
+            p += len;
+            p += strspn(p, " ,;");
+        }
+    }
+}
+
 // called from emsesp.cpp on every entity-change
-// queue schedules to be handled executed in scheduler-loop
+// queue all active onChange schedules watching this entity
 bool WebSchedulerService::onChange(const char * cmd) {
-    for (ScheduleItem & scheduleItem : *scheduleItems_) {
-        if (scheduleItem.active && scheduleItem.flags == SCHEDULEFLAG_SCHEDULE_ONCHANGE
-            && Helpers::toLower(scheduleItem.time).find(Helpers::toLower(cmd)) != std::string::npos) {
-            cmd_changed_.push_back(&scheduleItem);
-            return true;
+    bool found = false;
+    auto range = subscriptions_.equal_range(subscription_hash(cmd, strlen(cmd)));
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second.scheduleItem->active && !strcasecmp(it->second.path.c_str(), cmd)) {
+            cmd_changed_.push_back(it->second.scheduleItem);
+            found = true;
         }
     }
-    return false;
+    return found;
 }
 
 // handle condition schedules, parse string stored in schedule.time field
@@ -573,11 +616,27 @@ void WebSchedulerService::test() {
             si.elapsed_min = 0;
             si.retry_cnt   = 0xFF; // no startup retries
 
+            webScheduler.scheduleItems.push_back(si);
+
+            // test 3 and 4, two onChange schedules watching the same entity
+            si             = ScheduleItem();
+            si.active      = true;
+            si.flags       = SCHEDULEFLAG_SCHEDULE_ONCHANGE;
+            si.time        = "boiler/outdoortemp/value, thermostat/hc1/seltemp";
+            si.cmd         = "system/message";
+            si.value       = "\"outdoortemp changed\"";
+            si.name        = "";
+            si.elapsed_min = 0;
+            si.retry_cnt   = 0xFF;
+
+            webScheduler.scheduleItems.push_back(si);
+            si.time = "boiler/outdoortemp";
             webScheduler.scheduleItems.push_back(si);
             already_added = true;
 
             return StateUpdateResult::CHANGED; // persist the changes
         });
+        build_subscriptions(*scheduleItems_);
     }
 
     // test shunting yard
@@ -643,6 +702,11 @@ void WebSchedulerService::test() {
     test_value = "(boiler/storagetemp1/value)";
     command("test15", test_cmd.c_str(), compute(test_value).c_str());
 
+    // both onChange schedules should be triggered, case-insensitive
+    onChange("Boiler/OutdoorTemp");
+    command("test16", test_cmd.c_str(), std::to_string(cmd_changed_.size()));
+    cmd_changed_.clear();
+
     // test HTTP POST to call HA script
     // test_cmd = "{\"method\":\"POST\",\"url\":\"http://192.168.1.42:8123/api/services/script/test_notify2\", \"header\":{\"authorization\":\"Bearer "
     //            "eyJhbGciOiJIUzI1NiIsInR5cCI6IkpXVCJ9.eyJpc3MiOiJhMmNlYWI5NDgzMmI0ODE2YWQ2NzU4MjkzZDE2YWMxZSIsImlhdCI6MTcyMTM5MTI0NCwiZXhwIjoyMDM2NzUxMjQ0fQ."
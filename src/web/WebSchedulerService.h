@@ -85,6 +85,10 @@ class WebSchedulerService : public StatefulService<WebScheduler> {
     }
     uint8_t count_entities(bool cmd_only = false);
     bool    onChange(const char * cmd);
+    void    build_subscriptions(std::list<ScheduleItem> & scheduleItems);
+    bool    has_subscriptions() const {
+        return !subscriptions_.empty();
+    }
 
 #if defined(EMSESP_TEST)
     void test();
@@ -99,12 +103,22 @@ class WebSchedulerService : public StatefulService<WebScheduler> {
     bool command(const char * name, const std::string & cmd, const std::string & data);
     void condition();
 
+    static uint32_t subscription_hash(const char * path, size_t len);
+
+    // an onChange schedule watching an entity path, keyed by the hash of the lowercase path
+    struct Subscription {
+        std::string    path; // lowercase entity path without /value
+        ScheduleItem * scheduleItem;
+    };
+
     HttpEndpoint<WebScheduler>  _httpEndpoint;
     FSPersistence<WebScheduler> _fsPersistence;
 
     std::list<ScheduleItem> *  scheduleItems_; // pointer to the list of schedule events
     bool                       ha_registered_ = false;
     std::deque<ScheduleItem *> cmd_changed_;
+
+    std::unordered_multimap<uint32_t, Subscription> subscriptions_;
 };
 
 } // namespace emsesp
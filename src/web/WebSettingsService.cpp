@@ -448,7 +448,7 @@ void WebSettingsService::begin() {
 }
 
 void WebSettingsService::save() {
-    _fsPersistence.writeToFS();
+    _fsPersistence.write();
 }
 
 // build the json profile to send back
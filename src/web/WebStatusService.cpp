@@ -290,6 +290,7 @@ void WebStatusService::allvalues(JsonObject output) {
 // returns data for a specific feature/settings as a json object
 bool WebStatusService::exportData(JsonObject root, std::string & type) {
     root["type"] = type;
+    FSPersistenceBase::flushAll(); // the files must include pending changes
 
     if (type == "settings") {
         JsonObject node = root["System"].to<JsonObject>();
@@ -132,6 +132,57 @@ void shuntingYard_test21() {
     TEST_ASSERT_EQUAL_STRING(expected_result.c_str(), compute(test_value).c_str());
 }
 
+// compiled and cached expressions must give the same result on every evaluation
+void shuntingYard_test22() {
+    std::string expected_result = "5";
+    std::string test_value      = "boiler/storagetemp2 == \"\" ? 5 : 6";
+    TEST_ASSERT_EQUAL_STRING(expected_result.c_str(), compute(test_value).c_str());
+    TEST_ASSERT_EQUAL_STRING(expected_result.c_str(), compute(test_value).c_str());
+    clear_expression_cache();
+    TEST_ASSERT_EQUAL_STRING(expected_result.c_str(), compute(test_value).c_str());
+}
+
+// url values are kept out of the cached expression text
+void shuntingYard_test23() {
+    std::string test_value = std::string("(") + VALUE_MARK + "\x10 - 20) * 2 > 4";
+    TEST_ASSERT_EQUAL_STRING("1", calculate(test_value, {"22.5"}).c_str());
+    TEST_ASSERT_EQUAL_STRING("0", calculate(test_value, {"21"}).c_str());
+    TEST_ASSERT_EQUAL_STRING("1", calculate_text(insert_values(test_value, {"22.5"})).c_str());
+}
+
+// calculated values are compared with 6 decimals, like the text calculator
+void shuntingYard_test24() {
+    TEST_ASSERT_EQUAL_STRING("1", compute("0.1 + 0.2 == 0.3").c_str());
+    TEST_ASSERT_EQUAL_STRING("0", compute("0.1 + 0.2 != 0.3").c_str());
+    TEST_ASSERT_EQUAL_STRING("0", compute("0.1 + 0.2 > 0.3").c_str());
+    TEST_ASSERT_EQUAL_STRING(calculate_text("0.1 + 0.2 == 0.3").c_str(), compute("0.1 + 0.2 == 0.3").c_str());
+}
+
+// compare the compiled evaluator against the text calculator
+void shuntingYard_benchmark() {
+    std::string    test_value = "(22.5 - 20) * 2.8 + 5 > 10";
+    const uint16_t loops      = 1000;
+
+    TEST_ASSERT_EQUAL_STRING("1", calculate_text(test_value).c_str());
+    TEST_ASSERT_EQUAL_STRING("1", calculate(test_value).c_str());
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint16_t i = 0; i < loops; i++) {
+        calculate_text(test_value);
+    }
+    auto text_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (uint16_t i = 0; i < loops; i++) {
+        calculate(test_value);
+    }
+    auto compiled_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+    char msg[80];
+    snprintf(msg, sizeof(msg), "%u evaluations: text %lu us, compiled %lu us", loops, (unsigned long)text_us, (unsigned long)compiled_us);
+    TEST_MESSAGE(msg);
+}
+
 void run_shuntingYard_tests() {
     RUN_TEST(shuntingYard_test1);
     RUN_TEST(shuntingYard_test2);
@@ -154,4 +205,8 @@ void run_shuntingYard_tests() {
     RUN_TEST(shuntingYard_test19);
     RUN_TEST(shuntingYard_test20);
     RUN_TEST(shuntingYard_test21);
+    RUN_TEST(shuntingYard_test22);
+    RUN_TEST(shuntingYard_test23);
+    RUN_TEST(shuntingYard_test24);
+    RUN_TEST(shuntingYard_benchmark);
 }